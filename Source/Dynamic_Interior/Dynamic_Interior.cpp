@@ -1,6 +1,31 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Dynamic_Interior.h"
+#include "DynamicInteriorStats.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_STAT(STAT_WallsRebuilt);
+DEFINE_STAT(STAT_Rooms);
+DEFINE_STAT(STAT_TickingRooms);
+DEFINE_STAT(STAT_LiveSegments);
+DEFINE_STAT(STAT_PooledSegments);
+DEFINE_STAT(STAT_Objects);
+DEFINE_STAT(STAT_ApproxSegmentMemory);
+DEFINE_STAT(STAT_ApproxObjectMemory);
+DEFINE_STAT(STAT_CreateRoom);
+DEFINE_STAT(STAT_ConstructNextStep);
+DEFINE_STAT(STAT_UpdateAllWalls);
+DEFINE_STAT(STAT_UpdateWall);
+DEFINE_STAT(STAT_RebuildDirty);
+DEFINE_STAT(STAT_PrepareWallSegments);
+DEFINE_STAT(STAT_ClampDimensions);
+DEFINE_STAT(STAT_UpdateFloor);
+DEFINE_STAT(STAT_ApplySurfaces);
+DEFINE_STAT(STAT_AddObjectToWall);
+DEFINE_STAT(STAT_FillWallWithObjects);
+DEFINE_STAT(STAT_ApplyLOD);
+DEFINE_STAT(STAT_StartLayoutBatch);
+DEFINE_STAT(STAT_SolveRoom);
+DEFINE_STAT(STAT_ApplyLayoutBatch);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Dynamic_Interior, "Dynamic_Interior" );
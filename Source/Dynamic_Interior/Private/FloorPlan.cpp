@@ -0,0 +1,609 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FloorPlan.h"
+#include "RoomDescription.h"
+#include "DynamicInteriorStats.h"
+
+// Sets default values
+AFloorPlan::AFloorPlan()
+{
+	// Floor plan is rebuilt on edits only
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+// Called when the game starts or when spawned
+void AFloorPlan::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!FloorMesh || !WallMesh || !CeilingMesh)
+		UE_LOG(LogTemp, Warning, TEXT("Some mesh not set."));
+
+	if (bHasPendingDescription)
+	{
+		bHasPendingDescription = false;
+
+		BuildFromDescription(PendingDescription);
+		PendingDescription = FFloorPlanDescription();
+		return;
+	}
+
+	UpdatePlan();
+}
+
+int32 AFloorPlan::AddRoom(FBox2D room)
+{
+	const int32 index = Rooms.Add(room);
+
+	UpdatePlan();
+
+	return index;
+}
+
+void AFloorPlan::SetRoom(int32 index, FBox2D room)
+{
+	if (!Rooms.IsValidIndex(index))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Invalid room index %d."), index);
+		return;
+	}
+
+	Rooms[index] = room;
+
+	UpdatePlan();
+}
+
+void AFloorPlan::RemoveRoom(int32 index)
+{
+	if (!Rooms.IsValidIndex(index))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Invalid room index %d."), index);
+		return;
+	}
+
+	Rooms.RemoveAt(index);
+
+	UpdatePlan();
+}
+
+void AFloorPlan::UpdatePlan()
+{
+	UpdateGraph();
+	RebuildDirty();
+}
+
+TArray<UWallComponent*> AFloorPlan::GetRoomWalls(int32 index) const
+{
+	TArray<UWallComponent*> Result;
+
+	for (int32 idx = 0; idx < Graph.Num(); ++idx)
+	{
+		if (Graph[idx].HasRoom(index))
+			Result.Add(Walls[idx]);
+	}
+
+	return Result;
+}
+
+void AFloorPlan::EnableBoundingBoxes(bool value)
+{
+	bBoundingBoxesEnabled = value;
+
+	auto type = value ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision;
+
+	for (auto wall : Walls)
+	{
+		if (!IsValid(wall) || (!value && !IsValid(wall->BoundingBox)))
+			continue;
+
+		wall->UpdateBoundingBox()->SetCollisionEnabled(type);
+	}
+}
+
+void AFloorPlan::UpdateGraph()
+{
+	TArray<FFloorPlanWall> NewGraph;
+	FloorPlanLayout::BuildWallGraph(Rooms, WallOffset, NewGraph);
+
+	TArray<UWallComponent*> NewWalls;
+	NewWalls.SetNumZeroed(NewGraph.Num());
+
+	auto isBefore = [](const FFloorPlanWall& A, const FFloorPlanWall& B)
+	{
+		if (A.Axis != B.Axis)
+			return A.Axis < B.Axis;
+
+		if (A.Line != B.Line)
+			return A.Line < B.Line;
+
+		return A.Start < B.Start;
+	};
+
+	// Both graphs are sorted, so walls with unchanged edges are matched in one pass
+	TArray<int32> Removed;
+
+	int32 old = 0;
+	for (int32 idx = 0; idx < NewGraph.Num(); ++idx)
+	{
+		while (old < Graph.Num() && isBefore(Graph[old], NewGraph[idx]))
+			Removed.Add(old++);
+
+		if (old == Graph.Num() || !Graph[old].HasSameEdge(NewGraph[idx]))
+			continue;
+
+		auto wall = Walls[old];
+
+		// Corner given to other wall, keep openings at the same place and inside the new length
+		const float Shift	  = Graph[old].SolidStart - NewGraph[idx].SolidStart;
+		const float NewLength = NewGraph[idx].SolidEnd - NewGraph[idx].SolidStart;
+
+		if (wall->Objects.Num() > 0 && (Shift != 0.0f || NewLength != Graph[old].SolidEnd - Graph[old].SolidStart))
+			FitWallObjects(wall, Shift, NewLength);
+
+		NewWalls[idx] = wall;
+		++old;
+	}
+
+	while (old < Graph.Num())
+		Removed.Add(old++);
+
+	for (int32 idx = 0; idx < NewGraph.Num(); ++idx)
+	{
+		if (!NewWalls[idx])
+			NewWalls[idx] = CreateWall();
+	}
+
+	// Openings of split or merged walls move to the new wall at the same place on the line
+	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+
+	for (int32 idx : Removed)
+	{
+		const auto& Edge = Graph[idx];
+		auto wall = Walls[idx];
+
+		for (int32 obj = 0; obj < wall->Objects.Num(); ++obj)
+		{
+			auto object	 = wall->Objects[obj];
+			auto opening = wall->Openings.Get(obj);
+
+			const float Position = FloorPlanLayout::ToLinePosition(Edge, opening.Offset);
+			const int32 target	 = FloorPlanLayout::FindWall(NewGraph, Edge.Axis, Edge.Line, Position + opening.Width / 2.0f);
+
+			if (target != INDEX_NONE)
+			{
+				const auto& NewEdge = NewGraph[target];
+				auto newWall = NewWalls[target];
+
+				opening.Offset = FloorPlanLayout::FromLinePosition(NewEdge, Position);
+
+				// Object must fit on wall and keep aligment from objects moved there from other walls, as FitWallObjects does
+				const int32 next = RoomLayout::FindOpeningAfter(newWall->Openings, opening.Offset);
+				const float minOffset = (next > 0 ? newWall->Openings.GetEnd(next - 1) : 0.0f) + AligmentOffset;
+				const float maxEnd = (next < newWall->Openings.Num() ? newWall->Openings.Offsets[next] : NewEdge.SolidEnd - NewEdge.SolidStart) - AligmentOffset;
+
+				if (opening.Offset >= minOffset && opening.GetEnd() <= maxEnd)
+				{
+					// Objects are owned by their wall, so the destroyed wall must not stay their outer
+					const FName name = MakeUniqueObjectName(newWall, UObjectComponent::StaticClass(), FName(newWall->GetName() + "Obj"));
+					object->Rename(*name.ToString(), newWall, REN_DontCreateRedirectors | REN_NonTransactional);
+
+					object->AttachToComponent(newWall, rules);
+					object->offset = opening.Offset;
+
+					newWall->AddObject(object, opening, wall->Openings.MeshIndices[obj]);
+					newWall->DirtyFlags |= EWallDirtyFlags::Openings;
+					continue;
+				}
+			}
+
+			UE_LOG(LogTemp, Warning, TEXT("%s does not fit on changed wall and was removed."), *object->GetName());
+			object->DestroyComponent();
+		}
+
+		wall->Objects.Reset();
+		wall->Openings.Reset();
+
+		DestroyWall(wall);
+	}
+
+	Graph = MoveTemp(NewGraph);
+	Walls = MoveTemp(NewWalls);
+}
+
+void AFloorPlan::FitWallObjects(UWallComponent* wall, float Shift, float NewLength)
+{
+	for (int32 obj = 0; obj < wall->Objects.Num(); ++obj)
+		wall->SetObjectOffset(obj, wall->Openings.Offsets[obj] + Shift);
+
+	TArray<float> Offsets;
+	TArray<int32> Removed;
+	RoomLayout::FitOpenings(wall->Openings, NewLength, AligmentOffset, Offsets, Removed);
+
+	for (int32 obj = 0; obj < wall->Objects.Num(); ++obj)
+		wall->SetObjectOffset(obj, Offsets[obj]);
+
+	// From the end, so indices of other removed objects stay valid
+	for (int32 idx = Removed.Num() - 1; idx >= 0; --idx)
+	{
+		auto object = wall->Objects[Removed[idx]];
+
+		UE_LOG(LogTemp, Warning, TEXT("%s does not fit on changed wall and was removed."), *object->GetName());
+		DestroyWallObject(wall, object);
+	}
+
+	wall->DirtyFlags |= EWallDirtyFlags::Openings;
+}
+
+void AFloorPlan::RebuildDirty()
+{
+	const auto Settings = GetLayoutSettings();
+
+	const bool bSegmentsChanged = !bHasAppliedSettings || !RoomLayout::HaveSameSegmentParameters(Settings, AppliedSettings);
+
+	for (int32 idx = 0; idx < Graph.Num(); ++idx)
+	{
+		auto wall = Walls[idx];
+		if (!IsValid(wall))
+			continue;
+
+		// Walls keep their placement unless rooms around them changed
+		auto Placement = FloorPlanLayout::ComputeWallPlacement(Settings, Graph[idx]);
+		if (!(Placement == wall->AppliedPlacement))
+			wall->DirtyFlags |= EWallDirtyFlags::Placement;
+
+		if (bSegmentsChanged)
+			wall->DirtyFlags |= EWallDirtyFlags::Segments;
+
+		if (wall->DirtyFlags == EWallDirtyFlags::None)
+			continue;
+
+		if (EnumHasAnyFlags(wall->DirtyFlags, EWallDirtyFlags::Placement))
+			ApplyWallPlacement(wall, Placement);
+
+		FWallLayout Layout;
+		RoomLayout::SolveWall(Settings, Placement, wall->Openings, Layout);
+
+		FWallMeshData Mesh;
+		RoomLayout::BuildWallMesh(Settings, wall->AppliedPlacement, wall->Openings, Layout, WallUVSize, Mesh);
+
+		UpdateWallMesh(wall, Mesh);
+
+		// Transform objects
+		for (int32 obj = 0; obj < Layout.Openings.Num(); ++obj)
+			wall->Objects[obj]->SetRelativeLocationAndRotation(Layout.Openings[obj].Location, FRotator(0.0f, Layout.Openings[obj].Yaw, 0.0f));
+
+		wall->AppliedLayout = Layout;
+		wall->DirtyFlags = EWallDirtyFlags::None;
+
+		INC_DWORD_STAT(STAT_WallsRebuilt);
+	}
+
+	ApplySurfaces(Settings);
+
+	AppliedSettings		= Settings;
+	bHasAppliedSettings = true;
+}
+
+void AFloorPlan::ApplyWallPlacement(UWallComponent* wall, const FWallPlacement& Placement)
+{
+	wall->Length = Placement.Length;
+
+	wall->SetRelativeLocationAndRotation(Placement.Location, FRotator(0.0f, Placement.Yaw, 0.0f));
+
+	wall->AppliedPlacement = Placement;
+
+	// Disabled boxes are fitted when picking is enabled
+	if (bBoundingBoxesEnabled)
+		wall->UpdateBoundingBox()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+}
+
+void AFloorPlan::ApplySurfaces(const FRoomLayoutSettings& Settings)
+{
+	const bool bSettingsChanged = !bHasAppliedSettings || !(Settings == AppliedSettings);
+
+	// Removed rooms lose their floor and ceiling from the end
+	for (int32 idx = Floors.Num() - 1; idx >= Rooms.Num(); --idx)
+	{
+		if (IsValid(Floors[idx]))
+			Floors[idx]->DestroyComponent();
+
+		if (IsValid(Ceilings[idx]))
+			Ceilings[idx]->DestroyComponent();
+	}
+
+	const int32 numApplied = FMath::Min(AppliedRooms.Num(), Floors.Num());
+
+	Floors.SetNum(Rooms.Num());
+	Ceilings.SetNum(Rooms.Num());
+
+	for (int32 idx = 0; idx < Rooms.Num(); ++idx)
+	{
+		if (!bSettingsChanged && idx < numApplied && AppliedRooms[idx] == Rooms[idx])
+			continue;
+
+		if (!IsValid(Floors[idx]))
+			Floors[idx] = AddStaticMeshComponent(FloorMesh, MakeUniqueObjectName(GetRootComponent(), UStaticMeshComponent::StaticClass(), FName("Floor")));
+
+		if (!IsValid(Ceilings[idx]))
+			Ceilings[idx] = AddStaticMeshComponent(CeilingMesh, MakeUniqueObjectName(GetRootComponent(), UStaticMeshComponent::StaticClass(), FName("Ceiling")));
+
+		const auto Floor   = FloorPlanLayout::ComputeRoomSurface(Settings, Rooms[idx], 0.0f);
+		const auto Ceiling = FloorPlanLayout::ComputeRoomSurface(Settings, Rooms[idx], Settings.Height);
+
+		if (IsValid(Floors[idx]))
+		{
+			Floors[idx]->SetRelativeLocation(Floor.Location);
+			Floors[idx]->SetRelativeScale3D(Floor.Scale);
+		}
+
+		if (IsValid(Ceilings[idx]))
+		{
+			Ceilings[idx]->SetRelativeLocation(Ceiling.Location);
+			Ceilings[idx]->SetRelativeScale3D(Ceiling.Scale);
+		}
+	}
+
+	AppliedRooms = Rooms;
+}
+
+UWallComponent* AFloorPlan::CreateWall()
+{
+	auto name = MakeUniqueObjectName(GetRootComponent(), UWallComponent::StaticClass(), FName("Wall"));
+
+	UWallComponent* wall = NewObject<UWallComponent>(GetRootComponent(), UWallComponent::StaticClass(), name);
+
+	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+	wall->AttachToComponent(GetRootComponent(), rules);
+	AddInstanceComponent(wall);
+
+	wall->RegisterComponent();
+
+	return wall;
+}
+
+void AFloorPlan::DestroyWall(UWallComponent* wall)
+{
+	if (!IsValid(wall))
+		return;
+
+	for (auto obj : wall->Objects)
+	{
+		if (IsValid(obj))
+			obj->DestroyComponent();
+	}
+
+	if (IsValid(wall->ProceduralMesh))
+		wall->ProceduralMesh->DestroyComponent();
+
+	if (IsValid(wall->BoundingBox))
+		wall->BoundingBox->DestroyComponent();
+
+	wall->DestroyComponent();
+}
+
+void AFloorPlan::AddObjectToWall(UWallComponent* wall, float localPos, ObjectType type, int index)
+{
+	const int32 wallIndex = Walls.Find(wall);
+	if (!IsValid(wall) || wallIndex == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Wall component does not belong to floor plan."));
+		return;
+	}
+
+	if (!PlaceObject(wall, localPos, type, index))
+		return;
+
+	wall->DirtyFlags |= EWallDirtyFlags::Openings;
+
+	RebuildDirty();
+}
+
+void AFloorPlan::RemoveObjectFromWall(UObjectComponent* obj)
+{
+	auto wall = GetObjectWall(obj);
+
+	if (wall && DestroyWallObject(wall, obj))
+	{
+		wall->DirtyFlags |= EWallDirtyFlags::Openings;
+		RebuildDirty();
+	}
+}
+
+void AFloorPlan::MoveObject(UObjectComponent* obj, float newPos)
+{
+	auto wall = GetObjectWall(obj);
+	if (!wall)
+		return;
+
+	const int32 index = wall->FindObjectIndex(obj);
+	if (index == INDEX_NONE)
+		return;
+
+	SetObjectPosition(wall, index, newPos);
+
+	wall->DirtyFlags |= EWallDirtyFlags::Openings;
+	RebuildDirty();
+}
+
+FFloorPlanDescription AFloorPlan::ExportDescription() const
+{
+	// Plan is not built yet
+	if (bHasPendingDescription)
+		return PendingDescription;
+
+	FFloorPlanDescription description;
+	description.Height = Height;
+	description.Rooms  = Rooms;
+
+	for (int32 idx = 0; idx < Graph.Num(); ++idx)
+	{
+		auto wall = Walls[idx];
+		if (!IsValid(wall))
+			continue;
+
+		const auto& source = wall->Openings;
+
+		for (int32 obj = 0; obj < source.Num(); ++obj)
+		{
+			const ObjectType type = source.Types[obj] == ELayoutOpeningType::Window ? ObjectType::WINDOW : ObjectType::DOOR;
+
+			// Mesh lists may have been edited since the object was added
+			const auto& Meshes = type == ObjectType::DOOR ? DoorMeshes : WindowMeshes;
+			if (!Meshes.IsValidIndex(source.MeshIndices[obj]))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Opening %d of %s has invalid mesh index and is not saved."), obj, *wall->GetName());
+				continue;
+			}
+
+			// Position on center line stays valid when walls are split differently on load
+			FFloorPlanOpeningDescription& opening = description.Openings.AddDefaulted_GetRef();
+			opening.Axis	  = static_cast<uint8>(Graph[idx].Axis);
+			opening.Line	  = Graph[idx].Line;
+			opening.Position  = FloorPlanLayout::ToLinePosition(Graph[idx], source.Offsets[obj]);
+			opening.Type	  = type;
+			opening.MeshIndex = source.MeshIndices[obj];
+		}
+	}
+
+	return description;
+}
+
+bool AFloorPlan::ValidateDescription(const FFloorPlanDescription& description)
+{
+	// Walls of described rooms, the same graph BuildFromDescription creates
+	TArray<FFloorPlanWall> graph;
+	FloorPlanLayout::BuildWallGraph(description.Rooms, WallOffset, graph);
+
+	// Offset and width of objects on every wall
+	TArray<TArray<FVector2D>> spans;
+	spans.SetNum(graph.Num());
+
+	for (const auto& opening : description.Openings)
+	{
+		const auto& Meshes = opening.Type == ObjectType::DOOR ? DoorMeshes : WindowMeshes;
+		if (!Meshes.IsValidIndex(opening.MeshIndex) || opening.Axis > static_cast<uint8>(EFloorPlanAxis::Y))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Invalid opening in floor plan description."));
+			return false;
+		}
+
+		const float width = GetStaticMeshDimensions(Meshes[opening.MeshIndex]).Y;
+		const int32 target = FloorPlanLayout::FindWall(graph, static_cast<EFloorPlanAxis>(opening.Axis), opening.Line, opening.Position + width / 2.0f);
+
+		if (target == INDEX_NONE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Object at %.1f on line %d of floor plan description has no wall."), opening.Position, opening.Line);
+			return false;
+		}
+
+		spans[target].Add(FVector2D(FloorPlanLayout::FromLinePosition(graph[target], opening.Position), width));
+	}
+
+	// Objects must fit on their wall and must not overlap
+	for (int32 idx = 0; idx < graph.Num(); ++idx)
+	{
+		auto& wallSpans = spans[idx];
+		wallSpans.Sort([](const FVector2D& A, const FVector2D& B) { return A.X < B.X; });
+
+		float minOffset = AligmentOffset;
+
+		for (int32 obj = 0; obj < wallSpans.Num(); ++obj)
+		{
+			const float maxEnd = obj + 1 < wallSpans.Num() ? wallSpans[obj + 1].X : graph[idx].SolidEnd - graph[idx].SolidStart - AligmentOffset;
+
+			if (wallSpans[obj].X < minOffset || wallSpans[obj].X + wallSpans[obj].Y > maxEnd)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Wall %d of floor plan description has objects that do not fit."), idx);
+				return false;
+			}
+
+			minOffset = wallSpans[obj].X + wallSpans[obj].Y;
+		}
+	}
+
+	return true;
+}
+
+bool AFloorPlan::BuildFromDescription(const FFloorPlanDescription& description)
+{
+	// Description is applied completely or not at all
+	if (!ValidateDescription(description))
+		return false;
+
+	// Plan is built from description in BeginPlay
+	if (!HasActorBegunPlay() && !IsActorBeginningPlay())
+	{
+		PendingDescription = description;
+		bHasPendingDescription = true;
+
+		return true;
+	}
+
+	// Every wall is created again, so nothing of current plan is moved to new walls
+	for (auto wall : Walls)
+		DestroyWall(wall);
+
+	Walls.Reset();
+	Graph.Reset();
+
+	Height = description.Height;
+	Rooms  = description.Rooms;
+
+	UpdateGraph();
+
+	for (const auto& opening : description.Openings)
+	{
+		const auto& Meshes = opening.Type == ObjectType::DOOR ? DoorMeshes : WindowMeshes;
+		UStaticMesh* Mesh = Meshes[opening.MeshIndex];
+
+		const float width = GetStaticMeshDimensions(Mesh).Y;
+		const int32 target = FloorPlanLayout::FindWall(Graph, static_cast<EFloorPlanAxis>(opening.Axis), opening.Line, opening.Position + width / 2.0f);
+
+		if (target != INDEX_NONE)
+		{
+			const auto& Edge = Graph[target];
+			auto wall = Walls[target];
+
+			const float offset = FloorPlanLayout::FromLinePosition(Edge, opening.Position);
+
+			// Object must fit on wall and between its neighbours
+			const int32 next = RoomLayout::FindOpeningAfter(wall->Openings, offset);
+			const float minOffset = next > 0 ? wall->Openings.GetEnd(next - 1) : AligmentOffset;
+			const float maxOffset = (next < wall->Openings.Num() ? wall->Openings.Offsets[next] : Edge.SolidEnd - Edge.SolidStart - AligmentOffset) - width;
+
+			if (offset >= minOffset && offset <= maxOffset)
+			{
+				CreateObject(wall, Mesh, opening.Type, opening.MeshIndex, offset);
+				continue;
+			}
+		}
+
+		// Validated above, so this means the layout code disagrees with validation
+		UE_LOG(LogTemp, Error, TEXT("Saved object at %.1f on line %d does not fit on floor plan and was skipped."), opening.Position, opening.Line);
+	}
+
+	RebuildDirty();
+
+	return true;
+}
+
+void AFloorPlan::SaveToBytes(TArray<uint8>& data) const
+{
+	if (!RoomDescription::Save(ExportDescription(), data))
+		UE_LOG(LogTemp, Warning, TEXT("Floor plan has invalid mesh index and was not saved."));
+}
+
+bool AFloorPlan::LoadFromBytes(const TArray<uint8>& data)
+{
+	FFloorPlanDescription description;
+	if (!RoomDescription::Load(data, description))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Invalid floor plan data."));
+		return false;
+	}
+
+	return BuildFromDescription(description);
+}
@@ -0,0 +1,241 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FloorPlanLayout.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+	// Single side of room rectangle
+	struct FRoomEdge
+	{
+		EFloorPlanAxis Axis;
+		int32 Line;
+		int32 Start;
+		int32 End;
+		int32 Room;
+
+		// 0 if room lies on negative side of the line, 1 if on positive
+		int32 Side;
+	};
+
+	bool IsContinuation(const FFloorPlanWall& Prev, const FFloorPlanWall& Next)
+	{
+		return Prev.Axis == Next.Axis && Prev.Line == Next.Line && Prev.End == Next.Start;
+	}
+}
+
+void FloorPlanLayout::BuildWallGraph(TArrayView<const FBox2D> Rooms, float WallThickness, TArray<FFloorPlanWall>& OutWalls)
+{
+	OutWalls.Reset();
+
+	TArray<FRoomEdge> Edges;
+	Edges.Reserve(Rooms.Num() * 4);
+
+	for (int32 idx = 0; idx < Rooms.Num(); ++idx)
+	{
+		const int32 MinX = FMath::RoundToInt(Rooms[idx].Min.X);
+		const int32 MinY = FMath::RoundToInt(Rooms[idx].Min.Y);
+		const int32 MaxX = FMath::RoundToInt(Rooms[idx].Max.X);
+		const int32 MaxY = FMath::RoundToInt(Rooms[idx].Max.Y);
+
+		// Empty rooms have no walls
+		if (MaxX <= MinX || MaxY <= MinY)
+			continue;
+
+		Edges.Add({ EFloorPlanAxis::X, MinY, MinX, MaxX, idx, 1 });
+		Edges.Add({ EFloorPlanAxis::X, MaxY, MinX, MaxX, idx, 0 });
+		Edges.Add({ EFloorPlanAxis::Y, MinX, MinY, MaxY, idx, 1 });
+		Edges.Add({ EFloorPlanAxis::Y, MaxX, MinY, MaxY, idx, 0 });
+	}
+
+	// Edges on the same center line are next to each other, in room order so overlaps resolve the same on every run
+	Edges.Sort([](const FRoomEdge& A, const FRoomEdge& B)
+		{
+			if (A.Axis != B.Axis)
+				return A.Axis < B.Axis;
+
+			if (A.Line != B.Line)
+				return A.Line < B.Line;
+
+			return A.Room < B.Room;
+		});
+
+	TArray<int32> Breaks;
+
+	for (int32 First = 0; First < Edges.Num();)
+	{
+		int32 Last = First;
+		while (Last < Edges.Num() && Edges[Last].Axis == Edges[First].Axis && Edges[Last].Line == Edges[First].Line)
+			++Last;
+
+		// Rooms on each side can only change where some edge starts or ends
+		Breaks.Reset();
+		for (int32 idx = First; idx < Last; ++idx)
+		{
+			Breaks.Add(Edges[idx].Start);
+			Breaks.Add(Edges[idx].End);
+		}
+
+		Breaks.Sort();
+
+		for (int32 b = 0; b + 1 < Breaks.Num(); ++b)
+		{
+			const int32 Start = Breaks[b];
+			const int32 End	  = Breaks[b + 1];
+
+			if (End == Start)
+				continue;
+
+			int32 WallRooms[2] = { INDEX_NONE, INDEX_NONE };
+			for (int32 idx = First; idx < Last; ++idx)
+			{
+				const auto& Edge = Edges[idx];
+
+				// Overlapping rooms keep the one with lower index
+				if (Edge.Start <= Start && Edge.End >= End && WallRooms[Edge.Side] == INDEX_NONE)
+					WallRooms[Edge.Side] = Edge.Room;
+			}
+
+			if (WallRooms[0] == INDEX_NONE && WallRooms[1] == INDEX_NONE)
+				continue;
+
+			// Merge with previous interval if it separates the same rooms
+			if (OutWalls.Num() > 0)
+			{
+				auto& Prev = OutWalls.Last();
+
+				if (Prev.Axis == Edges[First].Axis && Prev.Line == Edges[First].Line && Prev.End == Start
+					&& Prev.Rooms[0] == WallRooms[0] && Prev.Rooms[1] == WallRooms[1])
+				{
+					Prev.End = End;
+					continue;
+				}
+			}
+
+			FFloorPlanWall& Wall = OutWalls.AddDefaulted_GetRef();
+			Wall.Axis	  = Edges[First].Axis;
+			Wall.Line	  = Edges[First].Line;
+			Wall.Start	  = Start;
+			Wall.End	  = End;
+			Wall.Rooms[0] = WallRooms[0];
+			Wall.Rooms[1] = WallRooms[1];
+		}
+
+		First = Last;
+	}
+
+	// Y walls own the corner squares: they grow over free ends and X walls are cut back where Y wall passes
+	const float HalfThickness = WallThickness / 2.0f;
+
+	const int32 FirstY = Algo::LowerBoundBy(OutWalls, EFloorPlanAxis::Y, [](const FFloorPlanWall& Wall)
+		{
+			return Wall.Axis;
+		});
+
+	const TArrayView<const FFloorPlanWall> WallsY(OutWalls.GetData() + FirstY, OutWalls.Num() - FirstY);
+
+	auto hasWallY = [&WallsY](int32 X, int32 Y)
+	{
+		// Walls on one line do not overlap, so End grows with Start
+		const int32 idx = Algo::LowerBound(WallsY, FIntPoint(X, Y), [](const FFloorPlanWall& Wall, const FIntPoint& Point)
+			{
+				return Wall.Line < Point.X || (Wall.Line == Point.X && Wall.End < Point.Y);
+			});
+
+		return idx < WallsY.Num() && WallsY[idx].Line == X && WallsY[idx].Start <= Y;
+	};
+
+	for (int32 idx = 0; idx < OutWalls.Num(); ++idx)
+	{
+		auto& Wall = OutWalls[idx];
+
+		Wall.SolidStart = Wall.Start;
+		Wall.SolidEnd	= Wall.End;
+
+		if (Wall.Axis == EFloorPlanAxis::Y)
+		{
+			if (idx == FirstY || !IsContinuation(OutWalls[idx - 1], Wall))
+				Wall.SolidStart -= HalfThickness;
+
+			if (idx + 1 == OutWalls.Num() || !IsContinuation(Wall, OutWalls[idx + 1]))
+				Wall.SolidEnd += HalfThickness;
+		}
+		else
+		{
+			if (hasWallY(Wall.Start, Wall.Line))
+				Wall.SolidStart += HalfThickness;
+
+			if (hasWallY(Wall.End, Wall.Line))
+				Wall.SolidEnd -= HalfThickness;
+		}
+	}
+}
+
+int32 FloorPlanLayout::FindWall(TArrayView<const FFloorPlanWall> Walls, EFloorPlanAxis Axis, int32 Line, float Position)
+{
+	const int32 idx = Algo::LowerBound(Walls, Position, [Axis, Line](const FFloorPlanWall& Wall, float Value)
+		{
+			if (Wall.Axis != Axis)
+				return Wall.Axis < Axis;
+
+			if (Wall.Line != Line)
+				return Wall.Line < Line;
+
+			return Wall.End < Value;
+		});
+
+	if (idx < Walls.Num() && Walls[idx].Axis == Axis && Walls[idx].Line == Line && Walls[idx].Start <= Position)
+		return idx;
+
+	return INDEX_NONE;
+}
+
+FWallPlacement FloorPlanLayout::ComputeWallPlacement(const FRoomLayoutSettings& Settings, const FFloorPlanWall& Wall)
+{
+	const float Thickness = Settings.WallOffset;
+
+	FWallPlacement Placement;
+	Placement.Length = FMath::Max(Wall.SolidEnd - Wall.SolidStart, 0.0f);
+
+	// Bounding box covers whole wall
+	Placement.Bounds.Location = FVector(Thickness / 2.0f, Placement.Length / 2.0f, Settings.Height / 2.0f);
+	Placement.Bounds.Scale	  = FVector(Thickness, Placement.Length, Settings.Height) / 100.0f;
+
+	// Wall local X goes across the wall, so center line is in the middle of thickness
+	if (Wall.Axis == EFloorPlanAxis::X)
+	{
+		Placement.Yaw = -90.0f;
+		Placement.Location = FVector(Wall.SolidStart, Wall.Line + Thickness / 2.0f, 0.0f);
+	}
+	else
+	{
+		Placement.Location = FVector(Wall.Line - Thickness / 2.0f, Wall.SolidStart, 0.0f);
+	}
+
+	return Placement;
+}
+
+FSegmentTransform FloorPlanLayout::ComputeRoomSurface(const FRoomLayoutSettings& Settings, const FBox2D& Room, float Z)
+{
+	const float HalfThickness = Settings.WallOffset / 2.0f;
+
+	const FVector2D Min = FVector2D(FMath::RoundToFloat(Room.Min.X), FMath::RoundToFloat(Room.Min.Y)) + FVector2D(HalfThickness);
+	const FVector2D Max = FVector2D(FMath::RoundToFloat(Room.Max.X), FMath::RoundToFloat(Room.Max.Y)) - FVector2D(HalfThickness);
+
+	FSegmentTransform Surface;
+	Surface.Location = FVector(Min.X, Min.Y, Z);
+	Surface.Scale	 = FVector(FMath::Max(Max.X - Min.X, 0.0f), FMath::Max(Max.Y - Min.Y, 0.0f), 1.0f);
+
+	return Surface;
+}
+
+float FloorPlanLayout::ToLinePosition(const FFloorPlanWall& Wall, float Offset)
+{
+	return Wall.SolidStart + Offset;
+}
+
+float FloorPlanLayout::FromLinePosition(const FFloorPlanWall& Wall, float Position)
+{
+	return Position - Wall.SolidStart;
+}
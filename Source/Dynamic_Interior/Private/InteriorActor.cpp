@@ -0,0 +1,231 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteriorActor.h"
+#include "Engine/StaticMesh.h"
+
+FRoomLayoutSettings AInteriorActor::GetLayoutSettings() const
+{
+	FRoomLayoutSettings Settings;
+	Settings.Height = Height;
+
+	Settings.WallOffset			= WallOffset;
+	Settings.DoorOffset			= DoorOffset;
+	Settings.WindowOffset		= WindowOffset;
+	Settings.WindowHeightOffset = WindowHeightOffset;
+	Settings.AligmentOffset		= AligmentOffset;
+
+	return Settings;
+}
+
+FVector AInteriorActor::GetStaticMeshDimensions(UStaticMesh* Mesh)
+{
+	if (auto cached = MeshDimensions.Find(Mesh))
+		return *cached;
+
+	if (!IsValid(Mesh))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Invalid static mesh."));
+		return FVector(0.0);
+	}
+
+	auto Box = Mesh->GetBoundingBox();
+
+	return MeshDimensions.Add(Mesh, Box.Max - Box.Min);
+}
+
+void AInteriorActor::CacheMeshDimensions()
+{
+	MeshDimensions.Reset();
+
+	for (auto Mesh : DoorMeshes)
+		GetStaticMeshDimensions(Mesh);
+
+	for (auto Mesh : WindowMeshes)
+		GetStaticMeshDimensions(Mesh);
+}
+
+UStaticMeshComponent* AInteriorActor::AddStaticMeshComponent(UWallComponent* WallComponent, UStaticMesh* Mesh, FName Name)
+{
+	if (!IsValid(WallComponent))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Wall component was null."));
+		return nullptr;
+	}
+
+	auto Obj = NewObject<UStaticMeshComponent>(this, UStaticMeshComponent::StaticClass(), Name);
+	if (!IsValid(Obj))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot create static mesh component."));
+		return nullptr;
+	}
+
+	Obj->SetStaticMesh(Mesh);
+	Obj->RegisterComponent();
+
+	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+	Obj->AttachToComponent(WallComponent, rules);
+
+	AddInstanceComponent(Obj);
+
+	return Obj;
+}
+
+UStaticMeshComponent* AInteriorActor::AddStaticMeshComponent(UStaticMesh* Mesh, FName Name)
+{
+	auto Obj = NewObject<UStaticMeshComponent>(GetRootComponent(), UStaticMeshComponent::StaticClass(), Name);
+	if (!IsValid(Obj))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot create static mesh component."));
+		return nullptr;
+	}
+
+	Obj->SetStaticMesh(Mesh);
+	Obj->RegisterComponent();
+
+	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+	Obj->AttachToComponent(GetRootComponent(), rules);
+
+	AddInstanceComponent(Obj);
+
+	return Obj;
+}
+
+void AInteriorActor::UpdateWallMesh(UWallComponent* wall, const FWallMeshData& Mesh)
+{
+	if (!IsValid(wall->ProceduralMesh))
+	{
+		FName name = FName(wall->GetName() + "_Mesh");
+
+		wall->ProceduralMesh = NewObject<UProceduralMeshComponent>(this, UProceduralMeshComponent::StaticClass(), name);
+		if (!IsValid(wall->ProceduralMesh))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Cannot create procedural mesh component."));
+			return;
+		}
+
+		// Wall blocks and is picked like segments do, collision is cooked off the game thread
+		wall->ProceduralMesh->bUseAsyncCooking = true;
+		wall->ProceduralMesh->RegisterComponent();
+
+		static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+		wall->ProceduralMesh->AttachToComponent(wall, rules);
+
+		AddInstanceComponent(wall->ProceduralMesh);
+	}
+
+	static const TArray<FColor> NoColors;
+	static const TArray<FProcMeshTangent> NoTangents;
+
+	// Same vertex count means same topology, only vertex buffer is rewritten
+	auto section = wall->ProceduralMesh->GetProcMeshSection(0);
+	if (section && section->ProcVertexBuffer.Num() == Mesh.Vertices.Num())
+	{
+		wall->ProceduralMesh->UpdateMeshSection(0, Mesh.Vertices, Mesh.Normals, Mesh.UVs, NoColors, NoTangents);
+	}
+	else
+	{
+		wall->ProceduralMesh->CreateMeshSection(0, Mesh.Vertices, Mesh.Triangles, Mesh.Normals, Mesh.UVs, NoColors, NoTangents, true);
+
+		if (IsValid(WallMesh))
+			wall->ProceduralMesh->SetMaterial(0, WallMesh->GetMaterial(0));
+	}
+}
+
+UObjectComponent* AInteriorActor::CreateObject(UWallComponent* wall, UStaticMesh* Mesh, ObjectType type, int32 meshIndex, float offset)
+{
+	const FVector meshDimensions = GetStaticMeshDimensions(Mesh);
+
+	// Create object and attach to wall component
+	auto name = MakeUniqueObjectName(wall, UObjectComponent::StaticClass(), FName(wall->GetName() + "Obj"));
+	auto obj = NewObject<UObjectComponent>(wall, UObjectComponent::StaticClass(), name);
+	if (!IsValid(obj))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot create static mesh component."));
+		return nullptr;
+	}
+
+	obj->SetStaticMesh(Mesh);
+	obj->SetDimensions(meshDimensions);
+	obj->RegisterComponent();
+
+	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+	obj->AttachToComponent(wall, rules);
+
+	AddInstanceComponent(obj);
+
+	obj->offset = offset;
+	obj->type = type;
+
+	FLayoutOpening opening;
+	opening.Offset = offset;
+	opening.Width  = meshDimensions.Y;
+	opening.Height = meshDimensions.Z;
+	opening.Type   = type == ObjectType::WINDOW ? ELayoutOpeningType::Window : ELayoutOpeningType::Door;
+
+	// Add object to wall component
+	wall->AddObject(obj, opening, meshIndex);
+
+	return obj;
+}
+
+UObjectComponent* AInteriorActor::PlaceObject(UWallComponent* wall, float localPos, ObjectType type, int32 meshIndex)
+{
+	// Get static mesh
+	const auto& Meshes = type == ObjectType::DOOR ? DoorMeshes : WindowMeshes;
+	if (!Meshes.IsValidIndex(meshIndex))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Invalid mesh index %d."), meshIndex);
+		return nullptr;
+	}
+
+	UStaticMesh* Mesh = Meshes[meshIndex];
+
+	// Get mesh dimensions
+	FVector meshDimensions = GetStaticMeshDimensions(Mesh);
+
+	// Find place in free gap under cursor, skip if gap is too small
+	float meshOffset = 0.0f;
+	if (!RoomLayout::FindFreeSlot(wall->Openings, wall->Length, AligmentOffset, meshDimensions.Y, localPos, false, meshOffset))
+		return nullptr;
+
+	return CreateObject(wall, Mesh, type, meshIndex, meshOffset);
+}
+
+UWallComponent* AInteriorActor::GetObjectWall(UObjectComponent* obj)
+{
+	if (!IsValid(obj))
+		return nullptr;
+
+	auto wall = Cast<UWallComponent>(obj->GetAttachParent());
+
+	return IsValid(wall) ? wall : nullptr;
+}
+
+bool AInteriorActor::DestroyWallObject(UWallComponent* wall, UObjectComponent* obj)
+{
+	if (!wall->RemoveObject(obj))
+		return false;
+
+	obj->DestroyComponent();
+
+	return true;
+}
+
+void AInteriorActor::SetObjectPosition(UWallComponent* wall, int32 index, float newPos)
+{
+	wall->SetObjectOffset(index, RoomLayout::ClampOpeningOffset(wall->Openings, wall->Length, AligmentOffset, index, newPos));
+}
+
+#if WITH_EDITOR
+void AInteriorActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	const FName name = PropertyChangedEvent.GetPropertyName();
+
+	// Meshes changed, cached dimensions are stale
+	if (name == GET_MEMBER_NAME_CHECKED(AInteriorActor, DoorMeshes) || name == GET_MEMBER_NAME_CHECKED(AInteriorActor, WindowMeshes))
+		CacheMeshDimensions();
+}
+#endif
@@ -2,9 +2,15 @@
 
 
 #include "ObjectComponent.h"
+#include "Engine/StaticMesh.h"
+#include "DynamicInteriorStats.h"
 
 FVector UObjectComponent::GetDimensions()
 {
+	// Mesh bounds are read only once
+	if (!Dimensions.IsZero())
+		return Dimensions;
+
 	if (!IsValid(this->GetStaticMesh()))
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Invalid static mesh."));
@@ -12,7 +18,39 @@ FVector UObjectComponent::GetDimensions()
 	}
 
 	auto Box = this->GetStaticMesh()->GetBoundingBox();
+	Dimensions = Box.Max - Box.Min;
+
+	return Dimensions;
+}
+
+void UObjectComponent::SetDimensions(const FVector& value)
+{
+	Dimensions = value;
+}
+
+bool UObjectComponent::SetStaticMesh(UStaticMesh* NewMesh)
+{
+	const bool bChanged = Super::SetStaticMesh(NewMesh);
 
-	return Box.Max - Box.Min;
+	// Recompute dimensions for new mesh on demand
+	if (bChanged)
+		Dimensions = FVector::ZeroVector;
+
+	return bChanged;
+}
+
+void UObjectComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	INC_DWORD_STAT(STAT_Objects);
+	INC_MEMORY_STAT_BY(STAT_ApproxObjectMemory, sizeof(UObjectComponent));
 }
 
+void UObjectComponent::OnUnregister()
+{
+	DEC_DWORD_STAT(STAT_Objects);
+	DEC_MEMORY_STAT_BY(STAT_ApproxObjectMemory, sizeof(UObjectComponent));
+
+	Super::OnUnregister();
+}
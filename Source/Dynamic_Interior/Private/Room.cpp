@@ -1,19 +1,74 @@
 // Fill out your copyright notice in the Description page of Project Settings.
-#pragma optimize("", off)
+
 
 #include "Room.h"
+#include "RoomDescription.h"
+#include "RoomLayoutSubsystem.h"
+#include "DynamicInteriorStats.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+	ELayoutRoomShape GetLayoutShape(RoomType type)
+	{
+		switch (type)
+		{
+		case RoomType::L_SHAPE:
+			return ELayoutRoomShape::LShape;
+		case RoomType::POLYGON:
+			return ELayoutRoomShape::Polygon;
+		default:
+			return ELayoutRoomShape::Standard;
+		}
+	}
+
+	// Compare wall openings with saved ones, offsets are skipped when only objects matter
+	bool MatchOpenings(const FWallOpenings& Openings, const FRoomWallDescription& Saved, bool bCompareOffsets)
+	{
+		if (Openings.Num() != Saved.Openings.Num())
+			return false;
+
+		for (int32 idx = 0; idx < Openings.Num(); ++idx)
+		{
+			const auto& opening = Saved.Openings[idx];
+			const ELayoutOpeningType type = opening.Type == ObjectType::WINDOW ? ELayoutOpeningType::Window : ELayoutOpeningType::Door;
+
+			if (Openings.Types[idx] != type || Openings.MeshIndices[idx] != opening.MeshIndex)
+				return false;
+
+			if (bCompareOffsets && Openings.Offsets[idx] != opening.Offset)
+				return false;
+		}
+
+		return true;
+	}
+
+	// Captured snapshots share equal parts, so pointers are compared
+	bool IsSameSnapshot(const FRoomSnapshot& A, const FRoomSnapshot& B)
+	{
+		return A.Length == B.Length && A.Width == B.Width && A.Height == B.Height && A.CornerX == B.CornerX && A.CornerY == B.CornerY
+			&& A.Outline == B.Outline && A.Walls == B.Walls;
+	}
+}
 
 // Sets default values
 ARoom::ARoom()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// Room is rebuilt by edits only, it never ticks
+	PrimaryActorTick.bCanEverTick = false;
 }
 
 // Called when the game starts or when spawned
 void ARoom::BeginPlay()
 {
 	Super::BeginPlay();
+
+	INC_DWORD_STAT(STAT_Rooms);
+
+	if (PrimaryActorTick.IsTickFunctionEnabled())
+		INC_DWORD_STAT(STAT_TickingRooms);
 	
 	if (!FloorMesh || !WallMesh || !CeilingMesh || DoorMeshes.Num() == 0 || WindowMeshes.Num() == 0)
 	{
@@ -21,841 +76,2292 @@ void ARoom::BeginPlay()
 		return;
 	}
 
-	CreateRoom(RoomType::STANDARD);
+	CacheMeshDimensions();
 
-	
-}
+	if (bRecordEdits)
+		StartEditLog();
 
-// Called every frame
-void ARoom::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
+	// Standard unless spawner chose shape or description before begin play
+	if (bHasPendingDescription)
+		Type = PendingDescription.Type;
 
-	this->SetActorEnableCollision(true);
+	auto Subsystem = GetWorld() ? GetWorld()->GetSubsystem<URoomLayoutSubsystem>() : nullptr;
 
-	
+	// Components are created over next frames, room is empty until OnRoomConstructed
+	if (bProgressiveConstruction && Subsystem)
+	{
+		ConstructionStep = 0;
+		Subsystem->QueueConstruction(this);
+	}
+	else
+	{
+		CreateRoom(Type);
+	}
+
+	if (bUseDistanceLOD && Subsystem)
+		Subsystem->RegisterLODRoom(this);
+
+	// Components created later follow actor collision flag
+	SetActorEnableCollision(bRoomCollisionEnabled);
 }
 
-void ARoom::EnableBoundingBoxes(bool value)
+void ARoom::SetRoomCollisionEnabled(bool value)
 {
-	auto type = value ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision;
+	if (bRoomCollisionEnabled == value && GetActorEnableCollision() == value)
+		return;
 
-	for (auto& boxComponent : WallBoundingBoxes)
-		boxComponent->SetCollisionEnabled(type);
+	bRoomCollisionEnabled = value;
+	SetActorEnableCollision(value);
 }
 
-void ARoom::CreateRoom(RoomType type)
+void ARoom::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Type = type;
-
-	if (type == RoomType::STANDARD)
+	// Drop pending end of frame rebuild
+	if (EndOfFrameHandle.IsValid())
 	{
-		// Create walls
-		for (int idx = 0; idx < 4; ++idx)
-		{
-			WallDirection dir = static_cast<WallDirection>(idx);
+		FWorldDelegates::OnWorldPostActorTick.Remove(EndOfFrameHandle);
+		EndOfFrameHandle.Reset();
+	}
 
-			UWallComponent* wall = NewObject<UWallComponent>(GetRootComponent(), UWallComponent::StaticClass(), FName("Wall" + FString::FromInt(idx + 1)));
+	if (bUseDistanceLOD && GetWorld())
+	{
+		if (auto Subsystem = GetWorld()->GetSubsystem<URoomLayoutSubsystem>())
+			Subsystem->UnregisterLODRoom(this);
+	}
 
-			// Keep references for editing door/window aligments
-			Walls.Add(dir, wall);
+	if (HasActorBegunPlay())
+	{
+		DEC_DWORD_STAT(STAT_Rooms);
 
-			static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
-			wall->AttachToComponent(this->RootComponent, rules);
-			AddInstanceComponent(wall);
+		if (PrimaryActorTick.IsTickFunctionEnabled())
+			DEC_DWORD_STAT(STAT_TickingRooms);
 
-			wall->RegisterComponent();
+		DEC_DWORD_STAT_BY(STAT_LiveSegments, SegmentPoolStats.Live);
+		DEC_DWORD_STAT_BY(STAT_PooledSegments, SegmentPool.Num());
+		DEC_MEMORY_STAT_BY(STAT_ApproxSegmentMemory, (SegmentPoolStats.Live + SegmentPool.Num()) * sizeof(UStaticMeshComponent));
+	}
 
-			wall->Direction = dir;
+	// Remaining segments are destroyed with the actor, walls forget them so they are not counted twice
+	SegmentPoolStats.Destroyed += SegmentPoolStats.Live + SegmentPool.Num();
+	SegmentPoolStats.Live = 0;
+	SegmentPool.Reset();
 
-			// Add bounding box to array
-			WallBoundingBoxes.Add(wall->BoundingBox);
+	for (auto wall : Walls)
+	{
+		if (IsValid(wall))
+		{
+			wall->HorizontalSegments.Reset();
+			wall->VerticalSegments.Reset();
+		}
+	}
 
-			// Create corner segment
-			auto cornerMesh = AddStaticMeshComponent(WallMesh, FName("Corner" + FString::FromInt(idx + 1)));
-			CornerSegments.Add(MakeWeakObjectPtr(cornerMesh));
+	Super::EndPlay(EndPlayReason);
+}
 
-			cornerMesh->RegisterComponent();
-			cornerMesh->AttachToComponent(this->RootComponent, rules);
-		}
+void ARoom::EnableBoundingBoxes(bool value)
+{
+	bBoundingBoxesEnabled = value;
 
-		// Prepare floor mesh
-		floor1 = AddStaticMeshComponent(FloorMesh, "Floor1");
-		floor1->SetVisibility(false);
+	auto type = value ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision;
 
-		// Prepare ceiling mesh
-		ceiling1 = AddStaticMeshComponent(CeilingMesh, "Ceiling");
-		ceiling1->SetVisibility(false);
-	}
-	else if (type == RoomType::L_SHAPE)
+	if (bUseRoomBoundingBox)
 	{
-		// Create 4 walls
-		for (int idx = 0; idx < 6; ++idx)
-		{
-			WallDirection dir = static_cast<WallDirection>(idx);
+		if (value)
+			UpdateRoomBoundingBox();
 
-			UWallComponent* wall = NewObject<UWallComponent>(GetRootComponent(), UWallComponent::StaticClass(), FName("Wall" + FString::FromInt(idx + 1)));
+		if (IsValid(RoomBoundingBox))
+			RoomBoundingBox->SetCollisionEnabled(type);
 
-			// Keep references for editing door/window aligments
-			Walls.Add(dir, wall);
-
-			static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
-			wall->AttachToComponent(this->RootComponent, rules);
+		return;
+	}
 
-			wall->RegisterComponent();
+	// Boxes are created when picking is enabled first time
+	for (auto wall : Walls)
+	{
+		if (!value && !IsValid(wall->BoundingBox))
+			continue;
 
-			wall->Direction = dir;
+		auto boxComponent = wall->UpdateBoundingBox();
+		boxComponent->SetCollisionEnabled(type);
 
-			// Add bounding box to array
-			WallBoundingBoxes.Add(wall->BoundingBox);
+		WallBoundingBoxes.AddUnique(boxComponent);
+	}
+}
 
-			// Create corner segment
-			auto cornerMesh = AddStaticMeshComponent(WallMesh, FName("Corner" + FString::FromInt(idx + 1)));
-			CornerSegments.Add(MakeWeakObjectPtr(cornerMesh));
+void ARoom::UpdateRoomBoundingBox()
+{
+	if (!IsValid(RoomBoundingBox))
+	{
+		RoomBoundingBox = NewObject<UBoxComponent>(this, UBoxComponent::StaticClass(), FName("RoomBoundingBox"));
+		RoomBoundingBox->SetHiddenInGame(false);
 
-			cornerMesh->RegisterComponent();
-			cornerMesh->AttachToComponent(this->RootComponent, rules);
-		}
+		static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+		RoomBoundingBox->AttachToComponent(this->RootComponent, rules);
 
-		// Prepare floor mesh
-		floor1 = AddStaticMeshComponent(FloorMesh, "Floor1");
-		floor1->SetVisibility(false);
+		RoomBoundingBox->RegisterComponent();
+		RoomBoundingBox->SetCollisionProfileName(FName("BlockAll"));
 
-		floor2 = AddStaticMeshComponent(FloorMesh, "Floor2");
-		floor2->SetVisibility(false);
+		AddInstanceComponent(RoomBoundingBox);
+	}
 
-		// Prepare ceiling mesh
-		ceiling1 = AddStaticMeshComponent(CeilingMesh, "Ceiling1");
-		ceiling1->SetVisibility(false);
+	// Box covers every wall
+	FBox Bounds(ForceInit);
+	for (auto wall : Walls)
+	{
+		const auto& Placement = wall->AppliedPlacement;
+		const FTransform WallTransform(FRotator(0.0f, Placement.Yaw, 0.0f), Placement.Location);
 
-		ceiling2 = AddStaticMeshComponent(CeilingMesh, "Ceiling2");
-		ceiling2->SetVisibility(false);
+		Bounds += WallTransform.TransformPosition(FVector(0.0f, 0.0f, 0.0f));
+		Bounds += WallTransform.TransformPosition(FVector(WallOffset, Placement.Length, Height));
 	}
 
-	// Disable bounding boxed
-	EnableBoundingBoxes(false);
+	if (!Bounds.IsValid)
+		return;
 
-	// Create room
-	UpdateAllWalls();
+	RoomBoundingBox->SetRelativeLocation(Bounds.GetCenter());
+	RoomBoundingBox->SetBoxExtent(Bounds.GetExtent());
 }
 
-// Create segments (wall static meshes) and adds door/window by type
-void ARoom::UpdateWall(WallDirection Direction)
+bool ARoom::PickWall(FVector origin, FVector direction, ObjectType type, int index, FWallPickResult& result)
 {
-	auto wall = Walls[Direction];
+	result = FWallPickResult();
 
-	// Update wall scale
-	UpdateWallTransform(Direction);
-	PrepareWallSegments(wall);
+	if (!IsValid(GetRootComponent()))
+		return false;
 
-	// Update wall segments
-	if (wall->Objects.Num() == 0)
-	{
-		auto WallSegment = wall->HorizontalSegments[0];
+	// Walls are placed relative to root, so ray is moved to the same space
+	const FTransform& RoomTransform = GetRootComponent()->GetComponentTransform();
+	const FVector Origin	= RoomTransform.InverseTransformPosition(origin);
+	const FVector Direction = RoomTransform.InverseTransformVector(direction);
 
-		WallSegment->SetRelativeLocation(FVector(0.0, 0.0, 0.0));
-		WallSegment->SetWorldScale3D(FVector(1.0, wall->Length, Height));
-	}
-	else
+	const auto Settings = GetLayoutSettings();
+
+	for (auto wall : Walls)
 	{
-		// Sort objects by their offset
-		wall->Objects.Sort([](const UObjectComponent& c1, const UObjectComponent& c2)
-			{
-				return c1.offset < c2.offset;
-			});
+		float distance = 0.0f;
+		FVector hit;
 
-		// Set transform to horizontal segments
-		float currentOffset = 0.0;
-		for (int idx = 0; idx < wall->HorizontalSegments.Num(); ++idx)
-		{
-			auto segment = wall->HorizontalSegments[idx];
+		if (!RoomLayout::IntersectWall(Settings, wall->AppliedPlacement, Origin, Direction, distance, hit))
+			continue;
 
-			if (idx == wall->HorizontalSegments.Num() - 1)
-			{
-				segment->SetRelativeLocation(FVector(0.0, currentOffset, 0.0));
-				segment->SetRelativeScale3D(FVector(1.0, wall->Length - currentOffset, Height));
-			}
-			else
-			{
-				auto obj	  = wall->Objects[idx];
-				auto objWidth = obj->GetDimensions().Y;
+		if (result.Wall && distance >= result.Distance)
+			continue;
 
-				segment->SetRelativeLocation(FVector(0.0, currentOffset, 0.0));
-				segment->SetRelativeScale3D(FVector(1.0, obj->offset - currentOffset, Height));
+		result.Wall			 = wall;
+		result.Distance		 = distance;
+		result.LocalPosition = hit.Y;
+	}
 
-				currentOffset += (obj->offset - currentOffset) + objWidth;
-			}
-		}
+	if (!result.Wall)
+		return false;
 
-		// Set transform to vertical segments
-		int segIndex = 0;
-		for (auto& obj : wall->Objects)
-		{
-			auto objHeight = obj->GetDimensions().Z;
-			auto objWidth = obj->GetDimensions().Y;
+	// Slot is resolved only for the closest wall, blocked cursor walks to nearest gap that fits
+	const auto& Meshes = type == ObjectType::DOOR ? DoorMeshes : WindowMeshes;
+	if (!Meshes.IsValidIndex(index))
+		return true;
 
-			if (obj->type == ObjectType::DOOR)
-			{
-				auto segment = wall->VerticalSegments[segIndex++];
+	const float Width = GetStaticMeshDimensions(Meshes[index]).Y;
 
-				segment->SetRelativeLocation(FVector(0.0, obj->offset, objHeight));
-				segment->SetRelativeScale3D(FVector(1.0, objWidth, Height - objHeight));
-			}
-			else if (obj->type == ObjectType::WINDOW)
-			{
-				auto segmentBottom  = wall->VerticalSegments[segIndex++];
-				auto segmentTop		= wall->VerticalSegments[segIndex++];
+	result.bHasSlot = RoomLayout::FindFreeSlot(result.Wall->Openings, result.Wall->Length, AligmentOffset, Width, result.LocalPosition, true, result.SlotOffset);
+	result.SlotPosition = result.SlotOffset + Width / 2.0f;
 
-				segmentBottom->SetRelativeLocation(FVector(0.0, obj->offset, 0.0));
-				segmentBottom->SetRelativeScale3D(FVector(1.0, objWidth, WindowHeightOffset));
+	return true;
+}
 
-				segmentTop->SetRelativeLocation(FVector(0.0, obj->offset, WindowHeightOffset + objHeight));
-				segmentTop->SetRelativeScale3D(FVector(1.0, objWidth, Height - (WindowHeightOffset + objHeight)));
-			}
-		}
+UWallComponent* ARoom::FindWallAt(FVector location, float& localPos) const
+{
+	UWallComponent* result = nullptr;
+	float bestDistance = MAX_flt;
 
-		// Transform objects
-		for (auto& obj : wall->Objects)
-		{
-			switch (obj->type)
-			{
-			case ObjectType::DOOR:
-				obj->SetRelativeLocation(FVector(DoorOffset, obj->offset, 0.0));
-				break;
-			case ObjectType::WINDOW:
-				obj->SetRelativeLocation(FVector(WindowOffset, obj->offset, WindowHeightOffset));
-				break;
-			}
+	// Closest wall face containing the point, room box hit is resolved without per-wall boxes
+	for (auto wall : Walls)
+	{
+		const FVector Local = wall->GetComponentTransform().InverseTransformPosition(location);
 
-			// Rotate obj by 180 degrees if needed
-			switch (wall->Direction)
-			{
-			case WallDirection::SOUTH:
-			case WallDirection::EAST:
-			case WallDirection::NORTH_EAST:
-				obj->SetWorldRotation(wall->GetComponentRotation().Vector().RotateAngleAxis(180.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-				obj->AddRelativeLocation(FVector(WallOffset / 2.0, obj->GetDimensions().Y, 0.0));
-				break;
-			}
+		if (Local.Y < 0.0f || Local.Y > wall->Length || Local.Z < 0.0f || Local.Z > Height)
+			continue;
+
+		const float distance = FMath::Abs(Local.X - WallOffset / 2.0f);
+		if (distance < bestDistance)
+		{
+			bestDistance = distance;
+			localPos = Local.Y;
+			result = wall;
 		}
 	}
+
+	return result;
 }
 
-void ARoom::PrepareWallSegments(UWallComponent* wall)
+void ARoom::CreateRoom(RoomType type)
 {
-	int numDoors = 0;
-	int numWindows = 0;
+	DYNAMIC_INTERIOR_SCOPE(STAT_CreateRoom);
 
-	// Count doors/windows
-	for (const auto& obj : wall->Objects)
+	FEditScope record(this, ERoomEditType::CreateRoom);
+	if (record.Edit)
+		record.Edit->Shape = type;
+
+	// Progressive construction in flight is finished with its own shape
+	if (ConstructionStep == INDEX_NONE)
 	{
-		if (obj->type == ObjectType::DOOR)
-			numDoors++;
-		if (obj->type == ObjectType::WINDOW)
-			numWindows++;
+		Type = type;
+		ConstructionStep = 0;
 	}
 
-	if (!numDoors && !numWindows)
-	{
-		wall->HorizontalSegments.SetNumUninitialized(1);
-		wall->VerticalSegments.SetNumUninitialized(0);
+	while (!ConstructNextStep())
+		;
+}
+
+bool ARoom::ConstructNextStep()
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_ConstructNextStep);
 
-		auto& segment = wall->HorizontalSegments[0];
-		FName name = FName(wall->GetName() + "_SegH");
+	// Walls updated by construction are not edits
+	TGuardValue<int32> noRecord(EditLogDepth, EditLogDepth + 1);
 
-		segment = MakeWeakObjectPtr<UStaticMeshComponent>(AddStaticMeshComponent(wall, WallMesh, name));
-	}
-	else
+	// Room without valid outline has no walls to build
+	FString error;
+	if (ConstructionStep == 0 && Walls.Num() == 0 && Type == RoomType::POLYGON && !RoomLayout::ValidateOutline(GetLayoutSettings(), Outline, error))
 	{
-		// Update count of segments
-		wall->HorizontalSegments.SetNumUninitialized(wall->Objects.Num() + 1);
-		wall->VerticalSegments.SetNumUninitialized(numDoors + numWindows * 2);
+		UE_LOG(LogTemp, Warning, TEXT("Invalid room outline: %s. Standard room is created."), *error);
+		Type = RoomType::STANDARD;
+	}
 
-		// Create horizontal segments on unallocated elements
-		for (auto& segment : wall->HorizontalSegments)
-		{
-			if (segment.IsValid()) continue;
+	const int numWalls = RoomLayout::GetNumWalls(GetLayoutSettings());
 
-			auto index = wall->HorizontalSegments.Find(segment);
-			FName name = FName(wall->GetName() + "_SegH" + FString::FromInt(index));
+	// One wall with its corner per step, outline may change between steps
+	if (ConstructionStep == 0 && Walls.Num() < numWalls)
+	{
+		CreateWall();
+		return false;
+	}
 
-			segment = MakeWeakObjectPtr<UStaticMeshComponent>(AddStaticMeshComponent(wall, WallMesh, name));
-		}
+	if (ConstructionStep == 0)
+	{
+		ConstructionStep++;
 
-		// Create vertical segments on unallocated elements
-		for (auto& segment : wall->VerticalSegments)
-		{
-			if (segment.IsValid()) continue;
+		// Wall and corner segments are transforms of one component, updated in batch
+		if (bUseInstancedSegments)
+			WallInstances = AddInstancedMeshComponent(WallMesh, "WallInstances");
 
-			auto index = wall->VerticalSegments.Find(segment);
-			FName name = FName(wall->GetName() + "_SegV" + FString::FromInt(index));
+		// Meshes are generated on first rebuild
+		FloorSurface   = AddProceduralMeshComponent("Floor");
+		CeilingSurface = AddProceduralMeshComponent("Ceiling");
 
-			segment = MakeWeakObjectPtr<UStaticMeshComponent>(AddStaticMeshComponent(wall, WallMesh, name));
-		}
+		return false;
 	}
-}
 
-void ARoom::UpdateWallLength(WallDirection direction)
-{
-	auto wall = Walls[direction];
+	// Every component exists, edits made during construction are applied by this rebuild
+	ConstructionStep = INDEX_NONE;
+	bRoomConstructed = true;
+
+	// Outline may have changed while walls were created
+	ResizeWalls(numWalls);
 
-	// Update wall scale
-	if (Type == RoomType::STANDARD)
+	if (bHasPendingDescription)
 	{
-		switch (direction)
-		{
-		case WallDirection::NORTH:
-		case WallDirection::SOUTH:
-			wall->Length = Width;
-			break;
-		case WallDirection::WEST:
-		case WallDirection::EAST:
-			wall->Length = Length;
-			break;
-		}
+		bHasPendingDescription = false;
+
+		// Empty walls and saved objects are laid out in one rebuild
+		BuildFromDescription(PendingDescription);
+		PendingDescription = FRoomDescription();
 	}
-	else if (Type == RoomType::L_SHAPE)
+	else
 	{
-		switch (direction)
-		{
-		case WallDirection::SOUTH:
-			//TODO: Set relative loc
-			wall->Length = Width;
-			break;
-		case WallDirection::WEST:
-			wall->Length = Length;
-			break;
-		case WallDirection::NORTH:
-			wall->Length = cornerY;
-			break;
-		case WallDirection::NORTH_EAST:
-			wall->Length = Length - cornerX - WallOffset;
-			break;
-		case WallDirection::EAST:
-			wall->Length = cornerX;
-			break;
-		case WallDirection::SOUTH_EAST:
-			wall->Length = Width - cornerY - WallOffset;
-			break;
-		}
+		// Create room
+		UpdateAllWalls();
 	}
+
+	// Background or end of frame rebuild finishes construction when it is applied
+	if (LayoutRevision != AppliedRevision)
+		bConstructedPending = true;
+	else
+		NotifyConstructed();
+
+	return true;
 }
 
-void ARoom::UpdateWallTransform(WallDirection direction)
+void ARoom::NotifyConstructed()
 {
-	auto wall = Walls[direction];
+	bConstructedPending = false;
 
-	UpdateWallLength(direction);
+	ClearUndoHistory();
 
-	// Update wall box component transform
-	wall->BoundingBox->SetRelativeLocation(FVector(AligmentOffset / 2.0, wall->Length / 2.0, Height / 2.0));
-	wall->BoundingBox->SetRelativeScale3D(FVector(AligmentOffset + 0.001, wall->Length, Height * 1.3) / 100.0);
+	OnRoomConstructed.Broadcast(this);
+}
 
-	// Update wall world position
-	if (Type == RoomType::STANDARD)
-	{
-		switch (wall->Direction)
-		{
-		case WallDirection::NORTH:
-			wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(0.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-			wall->SetRelativeLocation(FVector(wall->Length, 0.0, 0.0));
-			break;
-		case WallDirection::SOUTH:
-			wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(0.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-			wall->SetRelativeLocation(FVector(-WallOffset, 0.0, 0.0));
-			break;
-		case WallDirection::WEST:
-			wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(-90.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-			wall->SetRelativeLocation(FVector(0.0, 0.0, 0.0));
-			break;
-		case WallDirection::EAST:
-			wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(-90.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-			wall->SetRelativeLocation(FVector(0.0, wall->Length + WallOffset, 0.0));
-			break;
-		}
-	}
-	else if (Type == RoomType::L_SHAPE)
-	{
-		switch (wall->Direction)
-		{
-		case WallDirection::NORTH:
-			wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(0.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-			wall->SetRelativeLocation(FVector(wall->Length, 0.0, 0.0));
-			break;
-		case WallDirection::SOUTH:
-			wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(0.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-			wall->SetRelativeLocation(FVector(-WallOffset, 0.0, 0.0));
-			break;
-		case WallDirection::WEST:
-			wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(-90.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-			wall->SetRelativeLocation(FVector(0.0, 0.0, 0.0));
-			break;
-		case WallDirection::EAST:
-			wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(-90.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-			wall->SetRelativeLocation(FVector(0.0f, wall->Length + WallOffset, 0.0));
-			break;
-		case WallDirection::NORTH_EAST:
-			wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(-90.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-			wall->SetRelativeLocation(FVector(cornerX + WallOffset, cornerY + WallOffset, 0.0));
-			break;
-		case WallDirection::SOUTH_EAST:
-			wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(0.0f, FVector(0.0, 0.0, 1.0f)).Rotation());
-			wall->SetRelativeLocation(FVector(cornerX, cornerY + WallOffset, 0.0));
-			break;
-		}
-	}
+bool ARoom::IsRoomConstructed() const
+{
+	return bRoomConstructed;
 }
 
-void ARoom::UpdateAllWalls()
+UWallComponent* ARoom::CreateWall()
 {
-	// Clamp room dimensions
-	ClampDimensions();
+	const int idx = Walls.Num();
 
-	// Update corners
-	SetCorner({ cornerX, cornerY }, false);
+	// Removed wall may still hold the name until garbage collection
+	auto makeName = [this](const FString& base)
+	{
+		FName name = FName(base);
+		return FindObjectFast<UObject>(GetRootComponent(), name) ? MakeUniqueObjectName(GetRootComponent(), UStaticMeshComponent::StaticClass(), name) : name;
+	};
 
-	// Create/update floor mesh
-	UpdateFloor();
+	UWallComponent* wall = NewObject<UWallComponent>(GetRootComponent(), UWallComponent::StaticClass(), makeName("Wall" + FString::FromInt(idx + 1)));
 
-	// Update wall segments
-	for (auto& p : Walls)
-	{
-		auto& Direction = p.Key;
-		auto& wall = p.Value;
+	// Keep references for editing door/window aligments
+	Walls.Add(wall);
 
-		UpdateWall(Direction);
-	}
+	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+	wall->AttachToComponent(this->RootComponent, rules);
+	AddInstanceComponent(wall);
+
+	wall->RegisterComponent();
+
+	wall->Index = idx;
+
+	if (Type != RoomType::POLYGON)
+		wall->Direction = static_cast<WallDirection>(idx);
+
+	// Corners are drawn as wall instances
+	if (bUseInstancedSegments)
+		return wall;
+
+	// Create corner segment
+	auto cornerMesh = AddStaticMeshComponent(WallMesh, makeName("Corner" + FString::FromInt(idx + 1)));
+	CornerSegments.Add(MakeWeakObjectPtr(cornerMesh));
+
+	return wall;
 }
 
-void ARoom::AddObjectToWall(UWallComponent* wall, float localPos, ObjectType type, int index)
+void ARoom::DestroyWall(UWallComponent* wall)
 {
 	if (!IsValid(wall))
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Wall component was null."));
 		return;
+
+	for (auto obj : wall->Objects)
+	{
+		if (IsValid(obj))
+			obj->DestroyComponent();
 	}
 
-	// Get static mesh
-	UStaticMesh* Mesh = nullptr;
-	if (type == ObjectType::DOOR)
-		Mesh = DoorMeshes[index];
-	else if (type == ObjectType::WINDOW)
-		Mesh = WindowMeshes[index];
+	// Segments go back to pool and are attached to another wall on reuse
+	ResizeSegments(wall, wall->HorizontalSegments, 0);
+	ResizeSegments(wall, wall->VerticalSegments, 0);
 
-	// Get mesh dimensions
-	FVector meshDimensions	= GetStaticMeshDimensions(Mesh);
-	float meshOffset		= (int)(localPos - meshDimensions.Y / 2.0);
-	float requiredSpace		= meshDimensions.Y + 2 * AligmentOffset;
+	if (IsValid(wall->ProceduralMesh))
+		wall->ProceduralMesh->DestroyComponent();
 
-	// Correct object placing
-	if (wall->Objects.Num() != 0)
-	{
-		// Search for right object
-		auto obj = wall->Objects.FindByPredicate([&localPos](const UObjectComponent* comp)
-			{
-				return comp->offset > localPos;
-			});
+	if (IsValid(wall->LODBox))
+		wall->LODBox->DestroyComponent();
 
-		// 1. Check on the left of the right object
-		if (nullptr != obj)
-		{
-			// Get left obj
-			auto rightObj = *obj;
-			auto rightObjIndex  = wall->Objects.Find(rightObj);
+	if (IsValid(wall->BoundingBox))
+	{
+		WallBoundingBoxes.Remove(wall->BoundingBox);
+		wall->BoundingBox->DestroyComponent();
+	}
 
-			// 2. Check space between left and right objects
-			if (rightObjIndex != 0)
-			{
-				auto leftObj  = wall->Objects[rightObjIndex - 1];
-
-				// Awaible space between two objs
-				float awaibleSpace = rightObj->offset - (leftObj->offset + leftObj->GetDimensions().Y);
-
-				// If awaible space less than mesh width + two offsets -> return
-				if (awaibleSpace < requiredSpace)
-					return;
-
-				// Check where need to clamp
-				// If true -> close to rightObject
-				if (rightObj->offset - localPos < localPos - (leftObj->offset + leftObj->GetDimensions().Y))
-				{
-					// Clamp offset for current object
-					if (meshOffset > rightObj->offset - meshDimensions.Y - AligmentOffset)
-						meshOffset = rightObj->offset - meshDimensions.Y - AligmentOffset;
-				}
-				// If true -> close to leftObject
-				else
-				{
-					// Clamp offset for current object
-					if (meshOffset < leftObj->offset + leftObj->GetDimensions().Y + AligmentOffset)
-						meshOffset = leftObj->offset + leftObj->GetDimensions().Y + AligmentOffset;
-				}
-			}
-			else
-			{
-				// Awaible space between two objs
-				float awaibleSpace = rightObj->offset;
+	wall->DestroyComponent();
+}
 
-				// If awaible space less than mesh width + two offsets -> return
-				if (awaibleSpace < requiredSpace)
-					return;
+void ARoom::ResizeWalls(int32 num)
+{
+	while (Walls.Num() > num)
+	{
+		DestroyWall(Walls.Pop());
 
-				// Clamp offset for current object
-				if (meshOffset > rightObj->offset - meshDimensions.Y - AligmentOffset)
-					meshOffset = rightObj->offset - meshDimensions.Y - AligmentOffset;
-			}
-		}
-		// 3. Check on the right of the last object
-		else
+		if (CornerSegments.Num() > Walls.Num())
 		{
-			auto lastObj = wall->Objects.Last();
+			if (auto corner = CornerSegments.Pop().Get())
+				corner->DestroyComponent();
+		}
+	}
 
-			// Check if clicked on lastObj space
-			if (lastObj->offset + lastObj->GetDimensions().Y > localPos)
-				return;
+	while (Walls.Num() < num)
+		CreateWall();
 
-			// Awaible space between two objs
-			float awaibleSpace = wall->Length - (lastObj->offset + lastObj->GetDimensions().Y);
+	bSurfacesDirty = true;
+}
 
-			// If awaible space less than mesh width + two offsets -> return
-			if (awaibleSpace < requiredSpace)
-				return;
+// Create segments (wall static meshes) and adds door/window by type
+void ARoom::UpdateWall(WallDirection Direction)
+{
+	UpdateWallAt(static_cast<int32>(Direction));
+}
 
-			// Clamp offset for current object
-			if (meshOffset < lastObj->offset + lastObj->GetDimensions().Y + AligmentOffset)
-				meshOffset = lastObj->offset + lastObj->GetDimensions().Y + AligmentOffset;
-		}
-	}
-	
-	// Create object and attach to wall component
-	auto name = FName(wall->GetName() + "Obj" + FString::FromInt(wall->Objects.Num()));
-	auto obj = NewObject<UObjectComponent>(wall, UObjectComponent::StaticClass(), name);
-	if (!IsValid(obj))
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Cannot create static mesh component."));
+void ARoom::UpdateWallAt(int32 idx)
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_UpdateWall);
+
+	if (!Walls.IsValidIndex(idx))
 		return;
-	}
 
-	obj->SetStaticMesh(Mesh);
-	obj->RegisterComponent();
+	FEditScope record(this, ERoomEditType::UpdateWall);
+	if (record.Edit)
+		record.Edit->Wall = idx;
 
-	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
-	obj->AttachToComponent(wall, rules);
+	MarkWallDirty(Walls[idx], EWallDirtyFlags::Openings);
 
-	AddInstanceComponent(obj);
+	RequestRebuild();
+}
 
-	// Clamp obj offset between wall corners
-	obj->offset = FMath::Clamp(meshOffset, AligmentOffset, wall->Length - (AligmentOffset + meshDimensions.Y));
-	obj->type = type;
+UWallComponent* ARoom::GetWall(WallDirection Direction) const
+{
+	const int32 idx = static_cast<int32>(Direction);
 
-	// Add object to wall component
-	wall->Objects.Add(obj);
-	 
-	// Update wall
-	UpdateWall(wall->Direction);
+	return Walls.IsValidIndex(idx) ? Walls[idx] : nullptr;
 }
 
-void ARoom::RemoveObjectFromWall(UObjectComponent* obj)
+void ARoom::BeginEdit()
+{
+	FEditScope record(this, ERoomEditType::BeginEdit);
+
+	EditDepth++;
+	LayoutRevision++;
+}
+
+void ARoom::CommitEdit()
 {
-	if (!IsValid(obj))
+	if (EditDepth == 0)
 	{
+		UE_LOG(LogTemp, Warning, TEXT("CommitEdit called without BeginEdit."));
 		return;
 	}
 
-	auto wall = (UWallComponent*)obj->GetAttachParent();
+	FEditScope record(this, ERoomEditType::CommitEdit);
 
-	if (wall->Objects.Remove(obj) > 0)
+	// Apply all queued edits at once when outermost edit is commited
+	if (--EditDepth > 0)
+		return;
+
+	if (bAsyncLayout)
+		RequestRebuild();
+	else
+		FlushEdits();
+}
+
+void ARoom::FlushEdits()
+{
+	if (EndOfFrameHandle.IsValid())
 	{
-		obj->DestroyComponent();
-		UpdateWall(wall->Direction);
+		FWorldDelegates::OnWorldPostActorTick.Remove(EndOfFrameHandle);
+		EndOfFrameHandle.Reset();
 	}
-		
+
+	RebuildDirty();
 }
 
-void ARoom::MoveObject(UObjectComponent* obj, float newPos)
+void ARoom::RequestRebuild()
 {
-	if (!IsValid(obj))
+	LayoutRevision++;
+
+	// Edits are applied on CommitEdit
+	if (EditDepth > 0)
+		return;
+
+	if (bAsyncLayout && GetWorld())
+	{
+		if (auto Subsystem = GetWorld()->GetSubsystem<URoomLayoutSubsystem>())
+		{
+			Subsystem->QueueRoom(this);
+			return;
+		}
+	}
+
+	if (!bCoalesceEdits || !GetWorld())
 	{
+		RebuildDirty();
 		return;
 	}
 
-	auto wall = (UWallComponent*)obj->GetAttachParent();
+	// Apply all edits of this frame once after actors ticked
+	if (!EndOfFrameHandle.IsValid())
+		EndOfFrameHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ARoom::OnWorldPostActorTick);
+}
 
-	obj->offset = FMath::Clamp(newPos, AligmentOffset, wall->Length - AligmentOffset - obj->GetDimensions().Y);
+void ARoom::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || EditDepth > 0)
+		return;
 
-	UpdateWall(wall->Direction);
+	FlushEdits();
 }
 
-void ARoom::ClampDimensions()
+void ARoom::MarkWallDirty(UWallComponent* wall, EWallDirtyFlags Flags)
 {
-	if (Type == RoomType::STANDARD)
+	if (IsValid(wall))
+		wall->DirtyFlags |= Flags;
+}
+
+void ARoom::ApplySolvedLayout(const FRoomLayoutResult& Result, TArrayView<const FWallMeshData> Meshes)
+{
+	// Only clamped dimensions and corner may differ from current room
+	auto Expected = GetLayoutSettings();
+	Expected.Length	 = Result.Settings.Length;
+	Expected.Width	 = Result.Settings.Width;
+	Expected.CornerX = Result.Settings.CornerX;
+	Expected.CornerY = Result.Settings.CornerY;
+
+	if (!(Expected == Result.Settings) || Result.Walls.Num() != Walls.Num())
 	{
-		// Check minimal length
-		int minLength = minimalWallLength;
+		RebuildDirty();
+		return;
+	}
 
-		auto w1 = Walls[WallDirection::WEST];
-		if (w1->Objects.Num() > 0)
-		{
-			auto obj = w1->Objects.Last();
-			int min = obj->offset + obj->GetDimensions().Y + AligmentOffset;
-			if (minLength < min)
-				minLength = min;
-		}
+	Length	= Result.Settings.Length;
+	Width	= Result.Settings.Width;
+	cornerX = Result.Settings.CornerX;
+	cornerY = Result.Settings.CornerY;
 
-		auto w2 = Walls[WallDirection::EAST];
-		if (w2->Objects.Num() > 0)
-		{
-			auto obj = w2->Objects.Last();
-			int min = obj->offset + obj->GetDimensions().Y + AligmentOffset;
-			if (minLength < min)
-				minLength = min;
-		}
+	bDimensionsDirty = false;
 
-		if (Length < minLength)
-			Length = minLength;
+	RebuildDirty(&Result, Meshes);
+}
 
-		// Check minimal width
-		int minWidth = minimalWallLength;
+void ARoom::RebuildDirty(const FRoomLayoutResult* Solved, TArrayView<const FWallMeshData> Meshes)
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_RebuildDirty);
 
-		auto w3 = Walls[WallDirection::NORTH];
-		if (w3->Objects.Num() > 0)
-		{
-			auto obj = w3->Objects.Last();
-			int min = obj->offset + obj->GetDimensions().Y + AligmentOffset;
-			if (minWidth < min)
-				minWidth = min;
-		}
+	// Rebuild deferred to end of frame or to the layout subsystem, not called by an edit
+	const bool bDeferred = EditLogDepth == 0;
 
-		auto w4 = Walls[WallDirection::SOUTH];
-		if (w4->Objects.Num() > 0)
-		{
-			auto obj = w4->Objects.Last();
-			int min = obj->offset + obj->GetDimensions().Y + AligmentOffset;
-			if (minWidth < min)
-				minWidth = min;
-		}
+	// Clamping below is part of rebuild, not an edit
+	TGuardValue<int32> noRecord(EditLogDepth, EditLogDepth + 1);
 
-		if (Width < minWidth)
-			Width = minWidth;
-	}
-	else if (Type == RoomType::L_SHAPE)
+	// Edits during construction are applied when last wall exists
+	if (!bRoomConstructed)
+		return;
+
+	// Clamp room dimensions and corners before walls use them
+	if (bDimensionsDirty)
 	{
-		// Check minimal length
-		int minLength = minimalWallLength * 2;
+		bDimensionsDirty = false;
 
-		auto w1 = Walls[WallDirection::WEST];
-		if (w1->Objects.Num() > 0)
-		{
-			auto obj = w1->Objects.Last();
-			int min = obj->offset + obj->GetDimensions().Y + AligmentOffset;
-			if (minLength < min)
-				minLength = min;
-		}
+		ClampDimensions();
+		SetCorner({ cornerX, cornerY }, false);
+	}
 
-		auto w2 = Walls[WallDirection::NORTH_EAST];
-		// auto w3 = Walls[WallDirection::EAST];
+	const auto Settings = GetLayoutSettings();
 
-		if (w2->Objects.Num() > 0)
-		{
-			auto obj = w2->Objects.Last();
-			float min = (cornerX + WallOffset) + obj->offset + obj->GetDimensions().Y + AligmentOffset;
-			if (minLength < min)
-				minLength = min;
-		}
+	const bool bSettingsChanged = !bHasAppliedSettings || !(Settings == AppliedSettings);
+	const bool bSegmentsChanged = !bHasAppliedSettings || !RoomLayout::HaveSameSegmentParameters(Settings, AppliedSettings);
 
-		if (Length < minLength)
-			Length = minLength;
+	bool bInstancesDirty = false;
 
-		// Check minimal width
-		int minWidth = minimalWallLength * 2;
+	// Floor, ceiling and corners depend only on room settings
+	if (bSettingsChanged || bSurfacesDirty)
+	{
+		bSurfacesDirty = false;
+		bRoomProxyDirty = true;
 
-		auto w3 = Walls[WallDirection::SOUTH];
-		if (w3->Objects.Num() > 0)
+		if (Solved)
 		{
-			auto obj = w3->Objects.Last();
-			int min = obj->offset + obj->GetDimensions().Y + AligmentOffset;
-			if (minWidth < min)
-				minWidth = min;
+			ApplySurfaces(Solved->Surfaces);
 		}
-
-		auto w4 = Walls[WallDirection::SOUTH_EAST];
-		// auto w5 = Walls[WallDirection::NORTH];
-
-		if (w4->Objects.Num() > 0)
+		else
 		{
-			auto obj = w4->Objects.Last();
-			float min = (cornerY + WallOffset) + obj->offset + obj->GetDimensions().Y + AligmentOffset;
-			if (minWidth < min)
-				minWidth = min;
+			FSurfaceLayout Surfaces;
+			RoomLayout::ComputeSurfaces(Settings, Surfaces);
+			ApplySurfaces(Surfaces);
 		}
 
-		if (Width < minWidth)
-			Width = minWidth;
+		bInstancesDirty = true;
 	}
-}
 
-void ARoom::SetCorner(FVector2D corner, bool needUpdateWalls)
-{
-	cornerX = FMath::Clamp(corner.X, minimalWallLength, Length - minimalWallLength);
-	cornerY = FMath::Clamp(corner.Y, minimalWallLength, Width - minimalWallLength);
+	// Every wall placement comes from one pass over the outline
+	TArray<FWallPlacement> Placements;
+	if (!Solved)
+		RoomLayout::ComputeWallPlacements(Settings, Placements);
 
-	// Update corner walls
-	if (needUpdateWalls)
+	const TArray<FWallPlacement>& Placed = Solved ? Solved->Placements : Placements;
+	const int numWalls = FMath::Min(Walls.Num(), Placed.Num());
+
+	for (int idx = 0; idx < numWalls; ++idx)
 	{
-		UpdateWall(WallDirection::NORTH);
-		UpdateWall(WallDirection::EAST);
-		UpdateWall(WallDirection::NORTH_EAST);
-		UpdateWall(WallDirection::SOUTH_EAST);
+		auto wall = Walls[idx];
 
-		UpdateFloor();
-	}
-}
+		// Detect walls moved or resized by dimension changes
+		const auto& Placement = Placed[idx];
+		if (!(Placement == wall->AppliedPlacement))
+			wall->DirtyFlags |= EWallDirtyFlags::Placement;
 
-void ARoom::UpdateFloor()
-{
-	if (Type == RoomType::STANDARD)
-	{
-		floor1->SetRelativeLocation(FVector(0.0));
-		floor1->SetRelativeScale3D(FVector(Length, Width, 1.0));
-		floor1->SetVisibility(true);
-
-		// Create/update ceiling mesh
-		ceiling1->SetRelativeLocation(FVector(0.0, 0.0, Height));
-		ceiling1->SetRelativeScale3D(FVector(Length, Width, 1.0));
-		ceiling1->SetVisibility(true);
-
-		// Set corner transform
-		/*auto corner1 = CornerSegments[0];
-		corner1->SetRelativeLocation(FVector(-WallOffset, -WallOffset, 0.0));
-		corner1->SetRelativeScale3D(FVector(1.0, WallOffset, Height));
-		corner1->SetVisibility(true);
-
-		auto corner2 = CornerSegments[1];
-		corner2->SetRelativeLocation(FVector(Length, -WallOffset, 0.0));
-		corner2->SetRelativeScale3D(FVector(1.0, WallOffset, Height));
-		corner2->SetVisibility(true);
-
-		auto corner3 = CornerSegments[2];
-		corner3->SetRelativeLocation(FVector(Length, Width, 0.0));
-		corner3->SetRelativeScale3D(FVector(1.0, WallOffset, Height));
-		corner3->SetVisibility(true);
-
-		auto corner4 = CornerSegments[3];
-		corner4->SetRelativeLocation(FVector(-WallOffset, Width, 0.0));
-		corner4->SetRelativeScale3D(FVector(1.0, WallOffset, Height));
-		corner4->SetVisibility(true);*/
-	}
-	else if (Type == RoomType::L_SHAPE)
-	{
-		floor1->SetRelativeLocation(FVector(0.0, 0.0, 0.0));
-		floor1->SetRelativeScale3D(FVector(cornerX, Width, 1.0));
-
-		ceiling1->SetRelativeLocation(FVector(0.0, 0.0, Height));
-		ceiling1->SetRelativeScale3D(FVector(cornerX, Width, 1.0));
-
-		floor2->SetRelativeLocation(FVector(cornerX, 0.0, 0.0));
-		floor2->SetRelativeScale3D(FVector(Length - cornerX, cornerY, 1.0));
-
-		ceiling2->SetRelativeLocation(FVector(cornerX, 0.0, Height));
-		ceiling2->SetRelativeScale3D(FVector(Length - cornerX, cornerY, 1.0));
-
-		// Set visible
-		floor1->SetVisibility(true);
-		floor2->SetVisibility(true);
-		ceiling1->SetVisibility(true);
-		ceiling2->SetVisibility(true);
-
-		// Set corner transform
-		auto corner1 = CornerSegments[0];
-		corner1->SetRelativeLocation(FVector(-WallOffset, -WallOffset, 0.0));
-		corner1->SetRelativeScale3D(FVector(1.0, WallOffset, Height));
-		corner1->SetVisibility(true);
-
-		auto corner2 = CornerSegments[1];
-		corner2->SetRelativeLocation(FVector(Length, -WallOffset, 0.0));
-		corner2->SetRelativeScale3D(FVector(1.0, WallOffset, Height));
-		corner2->SetVisibility(true);
-
-		auto corner3 = CornerSegments[2];
-		corner3->SetRelativeLocation(FVector(Length, cornerY, 0.0));
-		corner3->SetRelativeScale3D(FVector(1.0, WallOffset, Height));
-		corner3->SetVisibility(true);
-
-		auto corner4 = CornerSegments[3];
-		corner4->SetRelativeLocation(FVector(cornerX, cornerY, 0.0));
-		corner4->SetRelativeScale3D(FVector(1.0, WallOffset, Height));
-		corner4->SetVisibility(true);
-
-		auto corner5 = CornerSegments[4];
-		corner5->SetRelativeLocation(FVector(cornerX, Width, 0.0));
-		corner5->SetRelativeScale3D(FVector(1.0, WallOffset, Height));
-		corner5->SetVisibility(true);
-
-		auto corner6 = CornerSegments[5];
-		corner6->SetRelativeLocation(FVector(-WallOffset, Width, 0.0));
-		corner6->SetRelativeScale3D(FVector(1.0, WallOffset, Height));
-		corner6->SetVisibility(true);
+		if (bSegmentsChanged)
+			wall->DirtyFlags |= EWallDirtyFlags::Segments;
+
+		// Unchanged walls do no component work
+		if (wall->DirtyFlags == EWallDirtyFlags::None)
+			continue;
+
+		if (EnumHasAnyFlags(wall->DirtyFlags, EWallDirtyFlags::Placement))
+			ApplyWallPlacement(wall, Placement);
+
+		// Openings are read in place, only background jobs take a copy
+		FWallLayout Layout;
+		if (!Solved)
+			RoomLayout::SolveWall(Settings, Placement, wall->Openings, Layout);
+
+		ApplyWallLayout(wall, wall->Openings, Solved ? Solved->Walls[idx] : Layout, Meshes.IsValidIndex(idx) ? &Meshes[idx] : nullptr);
+
+		wall->DirtyFlags = EWallDirtyFlags::None;
+		bInstancesDirty = true;
+
+		SegmentPoolStats.WallsRebuilt++;
+		INC_DWORD_STAT(STAT_WallsRebuilt);
 	}
-	
+
+	// Room box follows moved walls
+	if (bSettingsChanged && bBoundingBoxesEnabled && bUseRoomBoundingBox)
+		UpdateRoomBoundingBox();
+
+	AppliedSettings		= Settings;
+	bHasAppliedSettings = true;
+
+	// Rebuilt components are shown in full detail, simplified room hides them again
+	if (bInstancesDirty && LODLevel > 0)
+		ApplyLOD();
+	else if (bInstancesDirty)
+		UpdateInstances();
+
+	AppliedRevision = LayoutRevision;
+
+	if (bConstructedPending)
+		NotifyConstructed();
+	else if (bUndoStepPending && bDeferred)
+		PushUndoStep();
+}
+
+void ARoom::ApplyWallLayout(UWallComponent* wall, const FWallOpenings& Openings, const FWallLayout& Layout, const FWallMeshData* Mesh)
+{
+	if (bUseProceduralWalls)
+	{
+		// Whole wall is one mesh, segments are not needed
+		ResizeSegments(wall, wall->HorizontalSegments, 0);
+		ResizeSegments(wall, wall->VerticalSegments, 0);
+		wall->SegmentInstances.Reset();
+
+		ApplyWallMesh(wall, Openings, Layout, Mesh);
+	}
+	else if (bUseInstancedSegments)
+	{
+		// Store room space transforms, instances are synced in one batch
+		const FTransform WallTransform = wall->GetRelativeTransform();
+
+		wall->SegmentInstances.Reset(Layout.HorizontalSegments.Num() + Layout.VerticalSegments.Num());
+
+		for (const auto& segment : Layout.HorizontalSegments)
+			wall->SegmentInstances.Add(FTransform(FRotator::ZeroRotator, segment.Location, segment.Scale) * WallTransform);
+
+		for (const auto& segment : Layout.VerticalSegments)
+			wall->SegmentInstances.Add(FTransform(FRotator::ZeroRotator, segment.Location, segment.Scale) * WallTransform);
+
+		wall->bInstancesDirty = true;
+	}
+	else
+	{
+		PrepareWallSegments(wall);
+		ApplySegments(wall, Layout);
+	}
+
+	// Objects keep their transforms while the wall openings did not change
+	const bool bOpeningsChanged = EnumHasAnyFlags(wall->DirtyFlags, EWallDirtyFlags::Openings);
+	const auto& Applied = wall->AppliedLayout.Openings;
+
+	// Transform objects
+	for (int idx = 0; idx < Layout.Openings.Num(); ++idx)
+	{
+		if (!bOpeningsChanged && Applied.IsValidIndex(idx) && Applied[idx] == Layout.Openings[idx])
+			continue;
+
+		auto obj = wall->Objects[idx];
+
+		obj->SetRelativeLocationAndRotation(Layout.Openings[idx].Location, FRotator(0.0f, Layout.Openings[idx].Yaw, 0.0f));
+	}
+
+	wall->AppliedLayout = Layout;
+}
+
+void ARoom::ApplyWallMesh(UWallComponent* wall, const FWallOpenings& Openings, const FWallLayout& Layout, const FWallMeshData* Mesh)
+{
+	// Mesh is built here unless it was built in background
+	FWallMeshData Built;
+	if (!Mesh)
+	{
+		RoomLayout::BuildWallMesh(GetLayoutSettings(), wall->AppliedPlacement, Openings, Layout, WallUVSize, Built);
+		Mesh = &Built;
+	}
+
+	UpdateWallMesh(wall, *Mesh);
+}
+
+void ARoom::ApplySegments(UWallComponent* wall, const FWallLayout& Layout)
+{
+	// Segments are interchangeable, so only changed transforms are written
+	auto apply = [](TArray<TWeakObjectPtr<UStaticMeshComponent>>& Segments, const TArray<FSegmentTransform>& Transforms, const TArray<FSegmentTransform>& Applied)
+	{
+		for (int idx = 0; idx < Transforms.Num(); ++idx)
+		{
+			const auto& transform = Transforms[idx];
+			auto segment = Segments[idx];
+
+			if (Applied.IsValidIndex(idx) && Applied[idx].Location == transform.Location && Applied[idx].Scale == transform.Scale)
+				continue;
+
+			segment->SetRelativeLocation(transform.Location);
+			segment->SetRelativeScale3D(transform.Scale);
+		}
+	};
+
+	apply(wall->HorizontalSegments, Layout.HorizontalSegments, wall->AppliedLayout.HorizontalSegments);
+	apply(wall->VerticalSegments, Layout.VerticalSegments, wall->AppliedLayout.VerticalSegments);
+}
+
+void ARoom::PrepareWallSegments(UWallComponent* wall)
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_PrepareWallSegments);
+
+	int32 numHorizontal = 0;
+	int32 numVertical = 0;
+	RoomLayout::GetSegmentCounts(wall->Openings, numHorizontal, numVertical);
+
+	// Update count of segments, missing ones are taken from pool
+	ResizeSegments(wall, wall->HorizontalSegments, numHorizontal);
+	ResizeSegments(wall, wall->VerticalSegments, numVertical);
+}
+
+void ARoom::ResizeSegments(UWallComponent* wall, TArray<TWeakObjectPtr<UStaticMeshComponent>>& Segments, int32 Num)
+{
+	// Segment destroyed outside of the pool, e.g. together with its wall, is no longer live
+	auto forgetDestroyed = [this](const TWeakObjectPtr<UStaticMeshComponent>& segment)
+	{
+		if (!segment.IsStale())
+			return;
+
+		SegmentPoolStats.Live--;
+		SegmentPoolStats.Destroyed++;
+		DEC_DWORD_STAT(STAT_LiveSegments);
+		DEC_MEMORY_STAT_BY(STAT_ApproxSegmentMemory, sizeof(UStaticMeshComponent));
+	};
+
+	// Return unused segments to pool
+	for (int idx = Segments.Num() - 1; idx >= Num; --idx)
+	{
+		if (Segments[idx].IsValid())
+			ReleaseSegment(Segments[idx].Get());
+		else
+			forgetDestroyed(Segments[idx]);
+	}
+
+	Segments.SetNum(Num);
+
+	for (auto& segment : Segments)
+	{
+		if (!segment.IsValid())
+		{
+			forgetDestroyed(segment);
+			segment = MakeWeakObjectPtr(AcquireSegment(wall));
+		}
+	}
+}
+
+UStaticMeshComponent* ARoom::AcquireSegment(UWallComponent* wall)
+{
+	UStaticMeshComponent* segment = nullptr;
+
+	// Reuse hidden segment if possible
+	while (SegmentPool.Num() > 0 && !IsValid(segment))
+	{
+		segment = SegmentPool.Pop(false);
+		DEC_DWORD_STAT(STAT_PooledSegments);
+	}
+
+	if (IsValid(segment))
+	{
+		if (segment->GetAttachParent() != wall)
+		{
+			static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+			segment->AttachToComponent(wall, rules);
+		}
+
+		segment->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+		segment->SetVisibility(true);
+	}
+	else
+	{
+		FName name = MakeUniqueObjectName(this, UStaticMeshComponent::StaticClass(), FName(wall->GetName() + "_Seg"));
+
+		segment = AddStaticMeshComponent(wall, WallMesh, name);
+		if (!segment)
+			return nullptr;
+
+		SegmentPoolStats.Created++;
+		INC_MEMORY_STAT_BY(STAT_ApproxSegmentMemory, sizeof(UStaticMeshComponent));
+	}
+
+	SegmentPoolStats.Live++;
+	INC_DWORD_STAT(STAT_LiveSegments);
+
+	return segment;
+}
+
+void ARoom::ReleaseSegment(UStaticMeshComponent* segment)
+{
+	if (!IsValid(segment))
+		return;
+
+	SegmentPoolStats.Live--;
+	DEC_DWORD_STAT(STAT_LiveSegments);
+
+	// Destroy segment if pool is full
+	if (SegmentPool.Num() >= MaxPooledSegments)
+	{
+		segment->DestroyComponent();
+		SegmentPoolStats.Destroyed++;
+		DEC_MEMORY_STAT_BY(STAT_ApproxSegmentMemory, sizeof(UStaticMeshComponent));
+		return;
+	}
+
+	segment->SetVisibility(false);
+	segment->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	SegmentPool.Add(segment);
+	INC_DWORD_STAT(STAT_PooledSegments);
+}
+
+FSegmentPoolStats ARoom::GetSegmentPoolStats() const
+{
+	FSegmentPoolStats Stats = SegmentPoolStats;
+	Stats.Pooled = SegmentPool.Num();
+
+	for (auto wall : Walls)
+		Stats.Objects += IsValid(wall) ? wall->Objects.Num() : 0;
+
+	return Stats;
+}
+
+void ARoom::TrimSegmentPool(int32 MaxPooled)
+{
+	while (SegmentPool.Num() > FMath::Max(MaxPooled, 0))
+	{
+		auto segment = SegmentPool.Pop(false);
+		DEC_DWORD_STAT(STAT_PooledSegments);
+
+		if (IsValid(segment))
+		{
+			segment->DestroyComponent();
+			SegmentPoolStats.Destroyed++;
+			DEC_MEMORY_STAT_BY(STAT_ApproxSegmentMemory, sizeof(UStaticMeshComponent));
+		}
+	}
+}
+
+void ARoom::ApplyWallPlacement(UWallComponent* wall, const FWallPlacement& Placement)
+{
+	wall->Length = Placement.Length;
+
+	// Update wall world position
+	wall->SetWorldRotation(GetActorRotation().Vector().RotateAngleAxis(Placement.Yaw, FVector(0.0, 0.0, 1.0f)).Rotation());
+	wall->SetRelativeLocation(Placement.Location);
+
+	wall->AppliedPlacement = Placement;
+
+	// Disabled boxes are fitted when picking is enabled
+	if (bBoundingBoxesEnabled && !bUseRoomBoundingBox)
+		wall->UpdateBoundingBox();
+}
+
+void ARoom::UpdateAllWalls()
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_UpdateAllWalls);
+
+	FEditScope record(this, ERoomEditType::UpdateAllWalls);
+
+	// Walls unaffected by clamped dimensions are skipped
+	bDimensionsDirty = true;
+
+	RequestRebuild();
 }
 
-UStaticMeshComponent* ARoom::AddStaticMeshComponent(UWallComponent* WallComponent, UStaticMesh* Mesh, FName Name)
+void ARoom::SetLength(float value)
 {
-	if (!IsValid(WallComponent))
+	FEditScope record(this, ERoomEditType::SetLength);
+	if (record.Edit)
+		record.Edit->Value = value;
+
+	Length = value;
+	bDimensionsDirty = true;
+
+	RequestRebuild();
+}
+
+void ARoom::SetWidth(float value)
+{
+	FEditScope record(this, ERoomEditType::SetWidth);
+	if (record.Edit)
+		record.Edit->Value = value;
+
+	Width = value;
+	bDimensionsDirty = true;
+
+	RequestRebuild();
+}
+
+void ARoom::SetHeight(float value)
+{
+	FEditScope record(this, ERoomEditType::SetHeight);
+	if (record.Edit)
+		record.Edit->Value = value;
+
+	// Height only rescales vertical extents of every segment
+	Height = value;
+
+	RequestRebuild();
+}
+
+void ARoom::AddObjectToWall(UWallComponent* wall, float localPos, ObjectType type, int index)
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_AddObjectToWall);
+
+	if (!IsValid(wall))
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Wall component was null."));
-		return nullptr;
+		return;
 	}
 
-	auto Obj = NewObject<UStaticMeshComponent>(WallComponent, UStaticMeshComponent::StaticClass(), Name);
-	if (!IsValid(Obj))
+	FEditScope record(this, ERoomEditType::AddObject);
+	if (record.Edit)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Cannot create static mesh component."));
-		return nullptr;
+		record.Edit->Wall	   = Walls.Find(wall);
+		record.Edit->Opening   = type;
+		record.Edit->MeshIndex = index;
+		record.Edit->Value	   = localPos;
 	}
 
-	Obj->SetStaticMesh(Mesh);
-	Obj->RegisterComponent();
+	if (!PlaceObject(wall, localPos, type, index))
+		return;
 
-	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
-	Obj->AttachToComponent(WallComponent, rules);
+	// Update wall
+	MarkWallDirty(wall, EWallDirtyFlags::Openings);
+	RequestRebuild();
+}
 
-	AddInstanceComponent(Obj);
+int32 ARoom::FillWallWithObjects(UWallComponent* wall, ObjectType type, int index, int32 count, float pitch)
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_FillWallWithObjects);
 
-	return Obj;
+	if (!IsValid(wall))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Wall component was null."));
+		return 0;
+	}
+
+	FEditScope record(this, ERoomEditType::FillWall);
+	if (record.Edit)
+	{
+		record.Edit->Wall	   = Walls.Find(wall);
+		record.Edit->Opening   = type;
+		record.Edit->MeshIndex = index;
+		record.Edit->Count	   = count;
+		record.Edit->Value	   = pitch;
+	}
+
+	const auto& Meshes = type == ObjectType::DOOR ? DoorMeshes : WindowMeshes;
+	if (!Meshes.IsValidIndex(index))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Invalid mesh index %d."), index);
+		return 0;
+	}
+
+	UStaticMesh* Mesh = Meshes[index];
+	const FVector meshDimensions = GetStaticMeshDimensions(Mesh);
+
+	// Whole arrangement is found before any object is added
+	TArray<float> offsets;
+	if (RoomLayout::FillWall(wall->Openings, wall->Length, AligmentOffset, meshDimensions.Y, count, pitch, offsets) == 0)
+		return 0;
+
+	wall->Objects.Reserve(wall->Objects.Num() + offsets.Num());
+	wall->Openings.Reserve(wall->Openings.Num() + offsets.Num());
+
+	int32 added = 0;
+	for (float offset : offsets)
+	{
+		if (CreateObject(wall, Mesh, type, index, offset))
+			added++;
+	}
+
+	// Update wall once for all objects
+	MarkWallDirty(wall, EWallDirtyFlags::Openings);
+	RequestRebuild();
+
+	return added;
 }
 
-UStaticMeshComponent* ARoom::AddStaticMeshComponent(UStaticMesh* Mesh, FName Name)
+void ARoom::RemoveObjectFromWall(UObjectComponent* obj)
 {
-	auto Obj = NewObject<UStaticMeshComponent>(GetRootComponent(), UStaticMeshComponent::StaticClass(), Name);
-	if (!IsValid(Obj))
+	auto wall = GetObjectWall(obj);
+	if (!wall)
+		return;
+
+	FEditScope record(this, ERoomEditType::RemoveObject);
+	if (record.Edit)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Cannot create static mesh component."));
-		return nullptr;
+		record.Edit->Wall	= Walls.Find(wall);
+		record.Edit->Object = wall->FindObjectIndex(obj);
 	}
 
-	Obj->SetStaticMesh(Mesh);
-	Obj->RegisterComponent();
+	if (DestroyWallObject(wall, obj))
+	{
+		MarkWallDirty(wall, EWallDirtyFlags::Openings);
+		RequestRebuild();
+	}
+}
 
-	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
-	Obj->AttachToComponent(this->RootComponent, rules);
+void ARoom::MoveObject(UObjectComponent* obj, float newPos)
+{
+	auto wall = GetObjectWall(obj);
+	if (!wall)
+		return;
 
-	AddInstanceComponent(Obj);
+	const int32 index = wall->FindObjectIndex(obj);
+	if (index == INDEX_NONE)
+		return;
 
-	return Obj;
+	FEditScope record(this, ERoomEditType::MoveObject);
+	if (record.Edit)
+	{
+		record.Edit->Wall	= Walls.Find(wall);
+		record.Edit->Object = index;
+		record.Edit->Value	= newPos;
+	}
+
+	SetObjectPosition(wall, index, newPos);
+
+	MarkWallDirty(wall, EWallDirtyFlags::Openings);
+	RequestRebuild();
+}
+
+FRoomDescription ARoom::ExportDescription() const
+{
+	// Room is not created yet
+	if (bHasPendingDescription)
+		return PendingDescription;
+
+	FRoomDescription description;
+	description.Type	= Type;
+	description.Length	= Length;
+	description.Width	= Width;
+	description.Height	= Height;
+	description.CornerX = cornerX;
+	description.CornerY = cornerY;
+
+	if (Type == RoomType::POLYGON)
+		description.Outline = Outline;
+
+	const int numWalls = FMath::Min(RoomLayout::GetNumWalls(GetLayoutSettings()), Walls.Num());
+	description.Walls.SetNum(numWalls);
+
+	for (int idx = 0; idx < numWalls; ++idx)
+	{
+		auto wall = Walls[idx];
+		if (!IsValid(wall))
+			continue;
+
+		const auto& source = wall->Openings;
+
+		auto& openings = description.Walls[idx].Openings;
+		openings.Reserve(source.Num());
+
+		for (int obj = 0; obj < source.Num(); ++obj)
+		{
+			const ObjectType type = source.Types[obj] == ELayoutOpeningType::Window ? ObjectType::WINDOW : ObjectType::DOOR;
+
+			// Mesh lists may have been edited since the object was added
+			const auto& Meshes = type == ObjectType::DOOR ? DoorMeshes : WindowMeshes;
+			if (!Meshes.IsValidIndex(source.MeshIndices[obj]))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Opening %d of %s has invalid mesh index and is not saved."), obj, *wall->GetName());
+				continue;
+			}
+
+			FRoomOpeningDescription& opening = openings.AddDefaulted_GetRef();
+			opening.Type	  = type;
+			opening.MeshIndex = source.MeshIndices[obj];
+			opening.Offset	  = source.Offsets[obj];
+		}
+	}
+
+	return description;
 }
 
-FVector ARoom::GetStaticMeshDimensions(UStaticMesh* Mesh)
+bool ARoom::ValidateDescription(const FRoomDescription& description)
 {
-	if (!IsValid(Mesh))
+	auto Settings = GetLayoutSettings();
+	Settings.Shape	 = GetLayoutShape(description.Type);
+	Settings.Outline = description.Outline;
+
+	FString error;
+	if (Settings.Shape == ELayoutRoomShape::Polygon && !RoomLayout::ValidateOutline(Settings, Settings.Outline, error))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Room description has invalid outline: %s."), *error);
+		return false;
+	}
+
+	if (description.Walls.Num() > RoomLayout::GetNumWalls(Settings))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Room description has %d walls, room shape has %d."), description.Walls.Num(), RoomLayout::GetNumWalls(Settings));
+		return false;
+	}
+
+	if (Walls.Num() > 0 && description.Type != Type)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Shape of created room cannot be changed."));
+		return false;
+	}
+
+	TArray<FLayoutOpening> openings;
+
+	for (int idx = 0; idx < description.Walls.Num(); ++idx)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Invalid static mesh."));
-		return FVector(0.0);
+		openings.Reset();
+
+		for (const auto& opening : description.Walls[idx].Openings)
+		{
+			const auto& Meshes = opening.Type == ObjectType::DOOR ? DoorMeshes : WindowMeshes;
+			if (!Meshes.IsValidIndex(opening.MeshIndex))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Invalid mesh index %d."), opening.MeshIndex);
+				return false;
+			}
+
+			FLayoutOpening& layoutOpening = openings.AddDefaulted_GetRef();
+			layoutOpening.Offset = opening.Offset;
+			layoutOpening.Width	 = GetStaticMeshDimensions(Meshes[opening.MeshIndex]).Y;
+		}
+
+		openings.Sort([](const FLayoutOpening& A, const FLayoutOpening& B)
+			{
+				return A.Offset < B.Offset;
+			});
+
+		// Walls grow to fit openings on rebuild, but openings must not overlap
+		for (int obj = 0; obj < openings.Num(); ++obj)
+		{
+			const float minOffset = obj == 0 ? 0.0f : openings[obj - 1].GetEnd();
+
+			if (openings[obj].Offset < minOffset)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Wall %d of room description has overlapping objects."), idx);
+				return false;
+			}
+		}
 	}
 
-	auto Box = Mesh->GetBoundingBox();
+	return true;
+}
+
+bool ARoom::BuildFromDescription(const FRoomDescription& description)
+{
+	FEditScope record(this, ERoomEditType::BuildFromDescription);
+	if (record.Edit)
+		record.Edit->Description = description;
+
+	if (!ValidateDescription(description))
+		return false;
+
+	if (!bRoomConstructed)
+	{
+		if (HasActorBegunPlay() && ConstructionStep == INDEX_NONE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Room was not created."));
+			return false;
+		}
+
+		// Room is created from description when construction ends
+		PendingDescription = description;
+		bHasPendingDescription = true;
+
+		// Walls are created for saved outline
+		if (ConstructionStep == INDEX_NONE)
+			Type = description.Type;
+
+		if (Type == RoomType::POLYGON)
+			Outline = description.Outline;
+
+		return true;
+	}
+
+	// All changes below are applied by one rebuild
+	BeginEdit();
+
+	Length	= description.Length;
+	Width	= description.Width;
+	Height	= description.Height;
+	cornerX = description.CornerX;
+	cornerY = description.CornerY;
+
+	bDimensionsDirty = true;
+
+	// Polygon room gets walls of saved outline
+	if (Type == RoomType::POLYGON)
+	{
+		Outline = description.Outline;
+		ResizeWalls(RoomLayout::GetNumWalls(GetLayoutSettings()));
+	}
+
+	for (int idx = 0; idx < Walls.Num(); ++idx)
+	{
+		auto wall = Walls[idx];
+
+		for (auto obj : wall->Objects)
+		{
+			if (IsValid(obj))
+				obj->DestroyComponent();
+		}
+
+		wall->Objects.Reset();
+		wall->Openings.Reset();
+
+		if (description.Walls.IsValidIndex(idx))
+		{
+			wall->Objects.Reserve(description.Walls[idx].Openings.Num());
+			wall->Openings.Reserve(description.Walls[idx].Openings.Num());
+
+			for (const auto& opening : description.Walls[idx].Openings)
+			{
+				const auto& Meshes = opening.Type == ObjectType::DOOR ? DoorMeshes : WindowMeshes;
+
+				CreateObject(wall, Meshes[opening.MeshIndex], opening.Type, opening.MeshIndex, opening.Offset);
+			}
+		}
+
+		MarkWallDirty(wall, EWallDirtyFlags::Openings);
+	}
+
+	CommitEdit();
+
+	return true;
+}
+
+bool ARoom::SetOutline(const TArray<FVector2D>& points)
+{
+	FEditScope record(this, ERoomEditType::SetOutline);
+	if (record.Edit)
+		record.Edit->Outline = points;
+
+	if (Type != RoomType::POLYGON)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Outline is used by polygon rooms only."));
+		return false;
+	}
+
+	FString error;
+	if (!RoomLayout::ValidateOutline(GetLayoutSettings(), points, error))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Invalid room outline: %s."), *error);
+		return false;
+	}
+
+	Outline = points;
+
+	// Walls are created by construction
+	if (!bRoomConstructed)
+		return true;
+
+	BeginEdit();
+
+	ResizeWalls(points.Num());
+
+	// Outline is grown like room dimensions, rebuild stretches it past walls too short for their objects
+	for (auto wall : Walls)
+		MarkWallDirty(wall, EWallDirtyFlags::Openings);
+
+	bDimensionsDirty = true;
+
+	CommitEdit();
+
+	return true;
+}
+
+void ARoom::SaveToBytes(TArray<uint8>& data) const
+{
+	if (!RoomDescription::Save(ExportDescription(), data))
+		UE_LOG(LogTemp, Warning, TEXT("Room has invalid mesh index and was not saved."));
+}
+
+bool ARoom::LoadFromBytes(const TArray<uint8>& data)
+{
+	FRoomDescription description;
+	if (!RoomDescription::Load(data, description))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Invalid room data."));
+		return false;
+	}
+
+	return BuildFromDescription(description);
+}
+
+void ARoom::ClampDimensions()
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_ClampDimensions);
+
+	FEditScope record(this, ERoomEditType::ClampDimensions);
+
+	FRoomLayoutInput Input;
+	GatherLayoutInput(Input);
+
+	RoomLayout::ClampDimensions(Input.Settings, Input.Walls);
+
+	Length	= Input.Settings.Length;
+	Width	= Input.Settings.Width;
+	cornerX = Input.Settings.CornerX;
+	cornerY = Input.Settings.CornerY;
+
+	if (Type == RoomType::POLYGON)
+		Outline = Input.Settings.Outline;
+}
+
+void ARoom::SetCorner(FVector2D corner, bool needUpdateWalls)
+{
+	FEditScope record(this, ERoomEditType::SetCorner);
+	if (record.Edit)
+	{
+		record.Edit->Point		  = corner;
+		record.Edit->bUpdateWalls = needUpdateWalls;
+	}
+
+	auto clamped = RoomLayout::ClampCorner(GetLayoutSettings(), corner);
+
+	cornerX = clamped.X;
+	cornerY = clamped.Y;
+
+	// Only walls moved by corner are rebuilt
+	if (needUpdateWalls)
+		RequestRebuild();
+}
+
+void ARoom::UpdateFloor()
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_UpdateFloor);
+
+	FSurfaceLayout Surfaces;
+	RoomLayout::ComputeSurfaces(GetLayoutSettings(), Surfaces);
+
+	ApplySurfaces(Surfaces);
+	UpdateInstances();
+}
+
+void ARoom::ApplySurfaces(const FSurfaceLayout& Surfaces)
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_ApplySurfaces);
+
+	LocalBounds.Init();
+
+	for (const auto& point : Surfaces.Outline)
+	{
+		LocalBounds += FVector(point, 0.0f);
+		LocalBounds += FVector(point, Height);
+	}
+
+	// Walls stand outside of the outline
+	LocalBounds = LocalBounds.ExpandBy(FVector(WallOffset, WallOffset, 0.0f));
+
+	// Ceiling mesh is built at zero height, so height change only moves it
+	if (IsValid(CeilingSurface))
+		CeilingSurface->SetRelativeLocation(FVector(0.0f, 0.0f, Height));
+
+	if (!(Surfaces.Outline == AppliedOutline))
+	{
+		static const TArray<FColor> NoColors;
+		static const TArray<FProcMeshTangent> NoTangents;
+
+		auto build = [this, &Surfaces](UProceduralMeshComponent* Component, UStaticMesh* MaterialSource, bool bFaceUp)
+		{
+			if (!IsValid(Component))
+				return;
+
+			// Triangles change with outline, so section is always recreated
+			FWallMeshData Mesh;
+			if (!RoomLayout::BuildSurfaceMesh(Surfaces.Outline, bFaceUp, WallUVSize, Mesh))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Cannot triangulate room outline."));
+				Component->ClearAllMeshSections();
+				return;
+			}
+
+			Component->CreateMeshSection(0, Mesh.Vertices, Mesh.Triangles, Mesh.Normals, Mesh.UVs, NoColors, NoTangents, true);
+
+			if (IsValid(MaterialSource))
+				Component->SetMaterial(0, MaterialSource->GetMaterial(0));
+		};
+
+		build(FloorSurface, FloorMesh, true);
+		build(CeilingSurface, CeilingMesh, false);
+
+		AppliedOutline = Surfaces.Outline;
+	}
+
+	if (bUseInstancedSegments)
+	{
+		CornerTransforms.Reset(Surfaces.Corners.Num());
+
+		for (const auto& segment : Surfaces.Corners)
+			CornerTransforms.Add(FTransform(FRotator::ZeroRotator, segment.Location, segment.Scale));
+
+		bCornerInstancesDirty = true;
+		return;
+	}
+
+	// Set corner transform
+	for (int idx = 0; idx < Surfaces.Corners.Num() && idx < CornerSegments.Num(); ++idx)
+	{
+		auto corner = CornerSegments[idx];
+		if (!corner.IsValid())
+			continue;
+
+		corner->SetRelativeLocation(Surfaces.Corners[idx].Location);
+		corner->SetRelativeScale3D(Surfaces.Corners[idx].Scale);
+		corner->SetVisibility(true);
+	}
+}
+
+FRoomLayoutSettings ARoom::GetLayoutSettings() const
+{
+	FRoomLayoutSettings Settings = Super::GetLayoutSettings();
+	Settings.Shape = GetLayoutShape(Type);
+
+	if (Settings.Shape == ELayoutRoomShape::Polygon)
+		Settings.Outline = Outline;
+
+	Settings.Length = Length;
+	Settings.Width	= Width;
+
+	Settings.MinimalWallLength = minimalWallLength;
+
+	Settings.CornerX = cornerX;
+	Settings.CornerY = cornerY;
+
+	return Settings;
+}
+
+void ARoom::GatherWallInput(UWallComponent* wall, FWallLayoutInput& Input)
+{
+	// Job gets its own copy of the opening arrays
+	Input.Openings = wall->Openings;
+}
+
+void ARoom::GatherLayoutInput(FRoomLayoutInput& Input)
+{
+	Input.Settings = GetLayoutSettings();
+
+	const int32 NumWalls = FMath::Min(RoomLayout::GetNumWalls(Input.Settings), Walls.Num());
+	Input.Walls.SetNum(NumWalls);
+
+	for (int idx = 0; idx < NumWalls; ++idx)
+		GatherWallInput(Walls[idx], Input.Walls[idx]);
+}
+
+UInstancedStaticMeshComponent* ARoom::AddInstancedMeshComponent(UStaticMesh* Mesh, FName Name)
+{
+	auto Obj = NewObject<UInstancedStaticMeshComponent>(this, UInstancedStaticMeshComponent::StaticClass(), Name);
+	if (!IsValid(Obj))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot create instanced static mesh component."));
+		return nullptr;
+	}
+
+	Obj->SetStaticMesh(Mesh);
+	Obj->RegisterComponent();
+
+	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+	Obj->AttachToComponent(this->RootComponent, rules);
+
+	AddInstanceComponent(Obj);
+
+	return Obj;
+}
+
+UProceduralMeshComponent* ARoom::AddProceduralMeshComponent(FName Name)
+{
+	auto Obj = NewObject<UProceduralMeshComponent>(this, UProceduralMeshComponent::StaticClass(), Name);
+	if (!IsValid(Obj))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot create procedural mesh component."));
+		return nullptr;
+	}
+
+	Obj->RegisterComponent();
+
+	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+	Obj->AttachToComponent(this->RootComponent, rules);
+
+	AddInstanceComponent(Obj);
+
+	return Obj;
+}
+
+void ARoom::UpdateInstances()
+{
+	if (!bUseInstancedSegments || !IsValid(WallInstances))
+		return;
+
+	// Corners and segments of every wall share wall mesh, corners come first
+	TArray<FTransform> WallTransforms = CornerTransforms;
+
+	TBitArray<> Changed(bCornerInstancesDirty, CornerTransforms.Num());
+
+	// Range that changed its size moves all later instances, so they are written as well
+	bool bMoved = CornerTransforms.Num() != NumSyncedCorners;
+
+	bCornerInstancesDirty = false;
+	NumSyncedCorners = CornerTransforms.Num();
+
+	for (auto wall : Walls)
+	{
+		const int32 start = WallTransforms.Num();
+
+		// Simplified room draws one box per wall instead of its segments
+		if (LODLevel > 0)
+			WallTransforms.Add(FTransform(FRotator::ZeroRotator, FVector::ZeroVector, FVector(1.0f, wall->AppliedPlacement.Length, Height)) * wall->GetRelativeTransform());
+		else
+			WallTransforms.Append(wall->SegmentInstances);
+
+		const int32 num = WallTransforms.Num() - start;
+		bMoved |= num != wall->NumSyncedInstances;
+
+		Changed.Add(wall->bInstancesDirty || bMoved, num);
+
+		wall->bInstancesDirty = false;
+		wall->NumSyncedInstances = num;
+	}
+
+	SyncInstances(WallInstances, WallTransforms, Changed);
+}
+
+void ARoom::SetUseInstancedSegments(bool value)
+{
+	if (bUseInstancedSegments == value)
+		return;
+
+	bUseInstancedSegments = value;
+	ApplySegmentMode();
+}
+
+void ARoom::SetWallUVSize(float value)
+{
+	value = FMath::Max(value, 1.0f);
+	if (WallUVSize == value)
+		return;
+
+	WallUVSize = value;
+	ApplyWallUVSize();
+}
+
+void ARoom::ApplyWallUVSize()
+{
+	// UVs are baked into procedural meshes, segments use the mesh UVs
+	if (bUseProceduralWalls)
+	{
+		for (auto wall : Walls)
+			MarkWallDirty(wall, EWallDirtyFlags::Segments);
+	}
+
+	bSurfacesDirty = true;
+	RequestRebuild();
+}
+
+void ARoom::ApplySegmentMode()
+{
+	// Walls created later get components of current mode
+	if (Walls.Num() == 0)
+		return;
+
+	if (bUseInstancedSegments)
+	{
+		// Segments and corners become instances of one component
+		for (auto wall : Walls)
+		{
+			ResizeSegments(wall, wall->HorizontalSegments, 0);
+			ResizeSegments(wall, wall->VerticalSegments, 0);
+		}
+
+		for (auto& corner : CornerSegments)
+		{
+			if (corner.IsValid())
+				corner->DestroyComponent();
+		}
+
+		CornerSegments.Reset();
+
+		// Unconstructed room creates it in its second construction step
+		if (!IsValid(WallInstances) && (bRoomConstructed || ConstructionStep > 0))
+			WallInstances = AddInstancedMeshComponent(WallMesh, MakeUniqueObjectName(this, UInstancedStaticMeshComponent::StaticClass(), "WallInstances"));
+
+		bCornerInstancesDirty = true;
+		NumSyncedCorners = 0;
+	}
+	else
+	{
+		if (IsValid(WallInstances))
+			WallInstances->DestroyComponent();
+
+		WallInstances = nullptr;
+		CornerTransforms.Reset();
+
+		while (CornerSegments.Num() < Walls.Num())
+		{
+			FName name = MakeUniqueObjectName(this, UStaticMeshComponent::StaticClass(), FName("Corner" + FString::FromInt(CornerSegments.Num() + 1)));
+			CornerSegments.Add(MakeWeakObjectPtr(AddStaticMeshComponent(WallMesh, name)));
+		}
+	}
+
+	// Every wall is applied again, nothing of the old mode can be reused
+	for (auto wall : Walls)
+	{
+		wall->AppliedLayout = FWallLayout();
+		wall->SegmentInstances.Reset();
+		wall->bInstancesDirty = true;
+		wall->NumSyncedInstances = 0;
+
+		MarkWallDirty(wall, EWallDirtyFlags::Segments | EWallDirtyFlags::Openings);
+	}
+
+	bSurfacesDirty = true;
+	RequestRebuild();
+}
+
+void ARoom::SetLODLevel(int32 level)
+{
+	level = FMath::Clamp(level, 0, 2);
+	if (level == LODLevel)
+		return;
+
+	LODLevel = level;
+
+	// Walls are drawn as boxes or segments now
+	for (auto wall : Walls)
+		wall->bInstancesDirty = true;
+
+	// Unconstructed room applies its level after first rebuild
+	if (bRoomConstructed)
+		ApplyLOD();
+}
+
+int32 ARoom::GetLODLevel() const
+{
+	return LODLevel;
+}
+
+int32 ARoom::GetLODForDistance(float distance, float hysteresis) const
+{
+	const int32 level = distance > MergedRoomDistance ? 2 : distance > WallBoxDistance ? 1 : 0;
+
+	if (level >= LODLevel)
+		return level;
+
+	// Camera must come closer than distance of current level minus hysteresis
+	const float threshold = LODLevel == 2 ? MergedRoomDistance : WallBoxDistance;
+
+	return distance > threshold * (1.0f - hysteresis) ? LODLevel : level;
+}
+
+void ARoom::ApplyLOD()
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_ApplyLOD);
+
+	const bool bDetailed = LODLevel == 0;
+	const bool bMerged	 = LODLevel == 2;
+
+	// Wall boxes are separate components unless walls are instances
+	const bool bWallBoxes = LODLevel == 1 && !bUseInstancedSegments;
+
+	for (auto wall : Walls)
+	{
+		for (auto& segment : wall->HorizontalSegments)
+		{
+			if (segment.IsValid())
+				segment->SetVisibility(bDetailed);
+		}
+
+		for (auto& segment : wall->VerticalSegments)
+		{
+			if (segment.IsValid())
+				segment->SetVisibility(bDetailed);
+		}
+
+		if (IsValid(wall->ProceduralMesh))
+			wall->ProceduralMesh->SetVisibility(bDetailed);
+
+		if (bWallBoxes && !IsValid(wall->LODBox))
+		{
+			FName name = MakeUniqueObjectName(this, UStaticMeshComponent::StaticClass(), FName(wall->GetName() + "_LOD"));
+
+			wall->LODBox = AddStaticMeshComponent(wall, WallMesh, name);
+			if (IsValid(wall->LODBox))
+				wall->LODBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		}
+
+		// Box covers the whole wall like segment of wall without openings
+		if (IsValid(wall->LODBox))
+		{
+			if (bWallBoxes)
+				wall->LODBox->SetRelativeScale3D(FVector(1.0f, wall->AppliedPlacement.Length, Height));
+
+			wall->LODBox->SetVisibility(bWallBoxes);
+		}
+
+		ApplyObjectLOD(wall);
+	}
+
+	for (auto& corner : CornerSegments)
+	{
+		if (corner.IsValid())
+			corner->SetVisibility(!bMerged);
+	}
+
+	if (IsValid(WallInstances))
+		WallInstances->SetVisibility(!bMerged);
+
+	if (IsValid(FloorSurface))
+		FloorSurface->SetVisibility(!bMerged);
+
+	if (IsValid(CeilingSurface))
+		CeilingSurface->SetVisibility(!bMerged);
+
+	if (bMerged)
+		UpdateRoomProxy();
+
+	if (IsValid(RoomProxy))
+		RoomProxy->SetVisibility(bMerged);
+
+	UpdateInstances();
+}
+
+void ARoom::ApplyObjectLOD(UWallComponent* wall)
+{
+	const auto& openings = wall->Openings;
+
+	for (int32 idx = 0; idx < wall->Objects.Num(); ++idx)
+	{
+		auto obj = wall->Objects[idx];
+		if (!IsValid(obj))
+			continue;
+
+		obj->SetVisibility(LODLevel < 2);
+
+		const bool bDoor = openings.Types[idx] == ELayoutOpeningType::Door;
+		const auto& Meshes = bDoor ? DoorMeshes : WindowMeshes;
+		const int32 proxyIndex = bDoor ? ProxyDoorMesh : ProxyWindowMesh;
+
+		// Merged room keeps proxies, they are hidden anyway
+		const bool bProxy = LODLevel > 0 && Meshes.IsValidIndex(proxyIndex);
+		const int32 meshIndex = bProxy ? proxyIndex : openings.MeshIndices[idx];
+
+		if (!Meshes.IsValidIndex(meshIndex) || obj->GetStaticMesh() == Meshes[meshIndex])
+			continue;
+
+		// Proxy is stretched over the opening of original mesh
+		const FVector meshDimensions = GetStaticMeshDimensions(Meshes[meshIndex]);
+
+		FVector scale(1.0f);
+		if (bProxy && meshDimensions.Y > 0.0f && meshDimensions.Z > 0.0f)
+			scale = FVector(1.0f, openings.Widths[idx] / meshDimensions.Y, openings.Heights[idx] / meshDimensions.Z);
+
+		obj->SetStaticMesh(Meshes[meshIndex]);
+		obj->SetRelativeScale3D(scale);
+
+		// Dimensions still describe the opening
+		if (Meshes.IsValidIndex(openings.MeshIndices[idx]))
+			obj->SetDimensions(GetStaticMeshDimensions(Meshes[openings.MeshIndices[idx]]));
+	}
+}
+
+void ARoom::UpdateRoomProxy()
+{
+	if (IsValid(RoomProxy) && !bRoomProxyDirty)
+		return;
+
+	if (!IsValid(RoomProxy))
+	{
+		RoomProxy = AddProceduralMeshComponent("RoomProxy");
+		if (!IsValid(RoomProxy))
+			return;
+
+		RoomProxy->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+
+	bRoomProxyDirty = false;
+
+	static const TArray<FColor> NoColors;
+	static const TArray<FProcMeshTangent> NoTangents;
+
+	// Section per material: walls, floor and ceiling
+	auto setSection = [this](int32 section, const FWallMeshData& Mesh, UStaticMesh* MaterialSource)
+	{
+		RoomProxy->CreateMeshSection(section, Mesh.Vertices, Mesh.Triangles, Mesh.Normals, Mesh.UVs, NoColors, NoTangents, false);
+
+		if (IsValid(MaterialSource))
+			RoomProxy->SetMaterial(section, MaterialSource->GetMaterial(0));
+	};
+
+	TArray<FWallPlacement> placements;
+	placements.Reserve(Walls.Num());
+
+	for (auto wall : Walls)
+		placements.Add(wall->AppliedPlacement);
+
+	FWallMeshData Mesh;
+	RoomLayout::BuildMergedWallMesh(GetLayoutSettings(), placements, WallUVSize, Mesh);
+	setSection(0, Mesh, WallMesh);
+
+	// Floor and ceiling use the outline of surface meshes
+	if (RoomLayout::BuildSurfaceMesh(AppliedOutline, true, WallUVSize, Mesh))
+		setSection(1, Mesh, FloorMesh);
+
+	if (RoomLayout::BuildSurfaceMesh(AppliedOutline, false, WallUVSize, Mesh))
+	{
+		for (auto& vertex : Mesh.Vertices)
+			vertex.Z = Height;
+
+		setSection(2, Mesh, CeilingMesh);
+	}
+}
+
+void ARoom::SyncInstances(UInstancedStaticMeshComponent* Component, const TArray<FTransform>& Transforms, const TBitArray<>& Changed)
+{
+	if (!IsValid(Component))
+		return;
+
+	const int32 numInstances = Component->GetInstanceCount();
+
+	// Remove extra instances from the end, it does not shift other indices
+	for (int32 idx = numInstances - 1; idx >= Transforms.Num(); --idx)
+		Component->RemoveInstance(idx);
+
+	for (int32 idx = numInstances; idx < Transforms.Num(); ++idx)
+		Component->AddInstance(Transforms[idx]);
+
+	// Added instances are already in place, changed ones are written in contiguous runs
+	const int32 numExisting = FMath::Min(numInstances, Transforms.Num());
+
+	for (int32 idx = 0; idx < numExisting; ++idx)
+	{
+		if (!Changed[idx])
+			continue;
+
+		int32 end = idx + 1;
+		while (end < numExisting && Changed[end])
+			end++;
+
+		Component->BatchUpdateInstancesTransforms(idx, TArray<FTransform>(Transforms.GetData() + idx, end - idx), false, true, true);
+		idx = end;
+	}
+}
+
+ARoom::FEditScope::FEditScope(ARoom* room, ERoomEditType type)
+	: Room(room)
+	, Type(type)
+{
+	// Edits called by other edits are part of the outer one
+	if (Room->bRecordingEdits && Room->EditLogDepth == 0)
+	{
+		Start = FPlatformTime::Seconds();
+
+		Edit = &Room->EditLog.Edits.AddDefaulted_GetRef();
+		Edit->Type = type;
+		Edit->Time = static_cast<float>(Start - Room->EditLogStart);
+	}
+
+	Room->EditLogDepth++;
+}
+
+ARoom::FEditScope::~FEditScope()
+{
+	Room->EditLogDepth--;
+
+	if (Edit)
+		Edit->Duration = static_cast<float>(FPlatformTime::Seconds() - Start);
+
+	// Undo and redo move in history instead of adding to it
+	if (Room->EditLogDepth == 0 && Type != ERoomEditType::Undo && Type != ERoomEditType::Redo)
+	{
+		// Step is taken from the rebuilt room, deferred rebuild takes it when applied
+		Room->bUndoStepPending = true;
+
+		if (Room->AppliedRevision == Room->LayoutRevision)
+			Room->PushUndoStep();
+	}
+}
+
+void ARoom::CaptureSnapshot(const FRoomSnapshot* previous, FRoomSnapshot& snapshot) const
+{
+	snapshot.Length	 = Length;
+	snapshot.Width	 = Width;
+	snapshot.Height	 = Height;
+	snapshot.CornerX = cornerX;
+	snapshot.CornerY = cornerY;
+
+	if (previous && previous->Outline.IsValid() && *previous->Outline == Outline)
+		snapshot.Outline = previous->Outline;
+	else
+		snapshot.Outline = MakeShared<TArray<FVector2D>>(Outline);
+
+	snapshot.Walls.Reset(Walls.Num());
+
+	for (int idx = 0; idx < Walls.Num(); ++idx)
+	{
+		const auto& openings = Walls[idx]->Openings;
+
+		// Most edits change one wall, the rest is shared
+		if (previous && previous->Walls.IsValidIndex(idx) && MatchOpenings(openings, *previous->Walls[idx], true))
+		{
+			snapshot.Walls.Add(previous->Walls[idx]);
+			continue;
+		}
+
+		auto saved = MakeShared<FRoomWallDescription>();
+		saved->Openings.SetNum(openings.Num());
+
+		for (int obj = 0; obj < openings.Num(); ++obj)
+		{
+			auto& opening = saved->Openings[obj];
+			opening.Type	  = openings.Types[obj] == ELayoutOpeningType::Window ? ObjectType::WINDOW : ObjectType::DOOR;
+			opening.MeshIndex = openings.MeshIndices[obj];
+			opening.Offset	  = openings.Offsets[obj];
+		}
+
+		snapshot.Walls.Add(saved);
+	}
+}
+
+void ARoom::ApplySnapshot(const FRoomSnapshot& snapshot)
+{
+	// All changes below are applied by one rebuild
+	BeginEdit();
+
+	if (Length != snapshot.Length || Width != snapshot.Width || cornerX != snapshot.CornerX || cornerY != snapshot.CornerY)
+	{
+		Length	= snapshot.Length;
+		Width	= snapshot.Width;
+		cornerX = snapshot.CornerX;
+		cornerY = snapshot.CornerY;
+
+		bDimensionsDirty = true;
+	}
+
+	Height = snapshot.Height;
+
+	if (Type == RoomType::POLYGON && Outline != *snapshot.Outline)
+	{
+		Outline = *snapshot.Outline;
+		ResizeWalls(RoomLayout::GetNumWalls(GetLayoutSettings()));
+
+		bDimensionsDirty = true;
+	}
+
+	static const FRoomWallDescription emptyWall;
+
+	for (int idx = 0; idx < Walls.Num(); ++idx)
+	{
+		auto wall = Walls[idx];
+		const auto& saved = snapshot.Walls.IsValidIndex(idx) ? *snapshot.Walls[idx] : emptyWall;
+
+		if (MatchOpenings(wall->Openings, saved, true))
+			continue;
+
+		// Moved objects keep their components
+		if (MatchOpenings(wall->Openings, saved, false))
+		{
+			for (int obj = 0; obj < saved.Openings.Num(); ++obj)
+				wall->SetObjectOffset(obj, saved.Openings[obj].Offset);
+		}
+		else
+		{
+			for (auto obj : wall->Objects)
+			{
+				if (IsValid(obj))
+					obj->DestroyComponent();
+			}
+
+			wall->Objects.Reset();
+			wall->Openings.Reset();
+
+			for (const auto& opening : saved.Openings)
+			{
+				const auto& Meshes = opening.Type == ObjectType::DOOR ? DoorMeshes : WindowMeshes;
+
+				// Mesh lists may have been edited since the snapshot
+				if (Meshes.IsValidIndex(opening.MeshIndex))
+					CreateObject(wall, Meshes[opening.MeshIndex], opening.Type, opening.MeshIndex, opening.Offset);
+			}
+		}
+
+		MarkWallDirty(wall, EWallDirtyFlags::Openings);
+	}
+
+	CommitEdit();
+}
+
+void ARoom::PushUndoStep()
+{
+	// Edits of open BeginEdit are taken by CommitEdit as one step
+	if (EditDepth > 0)
+		return;
+
+	bUndoStepPending = false;
+
+	if (!bRoomConstructed || MaxUndoSteps <= 0)
+		return;
+
+	FRoomSnapshot snapshot;
+	CaptureSnapshot(UndoStack.Num() > 0 ? &UndoStack.Last() : nullptr, snapshot);
+
+	// Rejected edits did not change the room
+	if (UndoStack.Num() > 0 && IsSameSnapshot(snapshot, UndoStack.Last()))
+		return;
+
+	UndoStack.Add(MoveTemp(snapshot));
+	RedoStack.Reset();
+
+	// First snapshot is state before oldest step
+	if (UndoStack.Num() > MaxUndoSteps + 1)
+		UndoStack.RemoveAt(0, UndoStack.Num() - MaxUndoSteps - 1);
+}
+
+bool ARoom::Undo()
+{
+	// Edit still waiting for rebuild is the step undone, restoring it later clamps it the same way
+	if (bUndoStepPending)
+		PushUndoStep();
+
+	if (!CanUndo())
+		return false;
+
+	FEditScope record(this, ERoomEditType::Undo);
+
+	RedoStack.Add(UndoStack.Pop(false));
+	ApplySnapshot(UndoStack.Last());
+
+	return true;
+}
+
+bool ARoom::Redo()
+{
+	// Edit still waiting for rebuild drops redo steps like any other edit
+	if (bUndoStepPending)
+		PushUndoStep();
+
+	if (!CanRedo())
+		return false;
+
+	FEditScope record(this, ERoomEditType::Redo);
+
+	UndoStack.Add(RedoStack.Pop(false));
+	ApplySnapshot(UndoStack.Last());
+
+	return true;
+}
+
+bool ARoom::CanUndo() const
+{
+	return (UndoStack.Num() > 1 || (bUndoStepPending && UndoStack.Num() > 0)) && EditDepth == 0;
+}
+
+bool ARoom::CanRedo() const
+{
+	return RedoStack.Num() > 0 && !bUndoStepPending && EditDepth == 0;
+}
+
+void ARoom::ClearUndoHistory()
+{
+	UndoStack.Reset();
+	RedoStack.Reset();
+	bUndoStepPending = false;
+
+	if (!bRoomConstructed || MaxUndoSteps <= 0)
+		return;
+
+	CaptureSnapshot(nullptr, UndoStack.AddDefaulted_GetRef());
+}
+
+int32 ARoom::GetUndoHistorySize() const
+{
+	TSet<const void*> counted;
+	SIZE_T size = 0;
+
+	auto countSnapshot = [&](const FRoomSnapshot& snapshot)
+	{
+		size += sizeof(FRoomSnapshot) + snapshot.Walls.GetAllocatedSize();
+
+		bool bAlreadyCounted = false;
+		counted.Add(snapshot.Outline.Get(), &bAlreadyCounted);
+
+		if (!bAlreadyCounted)
+			size += sizeof(TArray<FVector2D>) + snapshot.Outline->GetAllocatedSize();
+
+		for (const auto& wall : snapshot.Walls)
+		{
+			counted.Add(wall.Get(), &bAlreadyCounted);
+
+			if (!bAlreadyCounted)
+				size += sizeof(FRoomWallDescription) + wall->Openings.GetAllocatedSize();
+		}
+	};
+
+	for (const auto& snapshot : UndoStack)
+		countSnapshot(snapshot);
+
+	for (const auto& snapshot : RedoStack)
+		countSnapshot(snapshot);
+
+	return static_cast<int32>(size);
+}
+
+void ARoom::StartEditLog()
+{
+	EditLog = FRoomEditLog();
+	EditLog.Initial = ExportDescription();
+
+	bRecordingEdits = true;
+	EditLogStart = FPlatformTime::Seconds();
+}
+
+void ARoom::StopEditLog()
+{
+	// Later edits are not in the log, so final room is the one recording ended with
+	if (bRecordingEdits)
+		EditLog.Final = ExportDescription();
+
+	bRecordingEdits = false;
+}
+
+bool ARoom::IsRecordingEdits() const
+{
+	return bRecordingEdits;
+}
+
+void ARoom::SaveEditLog(TArray<uint8>& data)
+{
+	if (bRecordingEdits)
+		EditLog.Final = ExportDescription();
+
+	if (!RoomDescription::Save(EditLog, data))
+		UE_LOG(LogTemp, Warning, TEXT("Edit log has invalid room description and was not saved."));
+}
+
+const FRoomEditLog& ARoom::GetEditLog() const
+{
+	return EditLog;
+}
+
+bool ARoom::ReplayEdit(const FRoomEdit& edit)
+{
+	auto wall = Walls.IsValidIndex(edit.Wall) ? Walls[edit.Wall] : nullptr;
+	auto obj  = IsValid(wall) && wall->Objects.IsValidIndex(edit.Object) ? wall->Objects[edit.Object] : nullptr;
+
+	switch (edit.Type)
+	{
+	case ERoomEditType::CreateRoom:
+		CreateRoom(edit.Shape);
+		return true;
+
+	case ERoomEditType::AddObject:
+		if (!IsValid(wall))
+			return false;
+
+		AddObjectToWall(wall, edit.Value, edit.Opening, edit.MeshIndex);
+		return true;
+
+	case ERoomEditType::MoveObject:
+		if (!IsValid(obj))
+			return false;
+
+		MoveObject(obj, edit.Value);
+		return true;
+
+	case ERoomEditType::RemoveObject:
+		if (!IsValid(obj))
+			return false;
+
+		RemoveObjectFromWall(obj);
+		return true;
+
+	case ERoomEditType::SetCorner:
+		SetCorner(edit.Point, edit.bUpdateWalls);
+		return true;
+
+	case ERoomEditType::SetLength:
+		SetLength(edit.Value);
+		return true;
+
+	case ERoomEditType::SetWidth:
+		SetWidth(edit.Value);
+		return true;
+
+	case ERoomEditType::SetHeight:
+		SetHeight(edit.Value);
+		return true;
+
+	case ERoomEditType::ClampDimensions:
+		ClampDimensions();
+		return true;
+
+	case ERoomEditType::UpdateWall:
+		if (!IsValid(wall))
+			return false;
+
+		UpdateWallAt(edit.Wall);
+		return true;
+
+	case ERoomEditType::UpdateAllWalls:
+		UpdateAllWalls();
+		return true;
+
+	case ERoomEditType::SetOutline:
+		SetOutline(edit.Outline);
+		return true;
+
+	case ERoomEditType::BuildFromDescription:
+		BuildFromDescription(edit.Description);
+		return true;
+
+	case ERoomEditType::BeginEdit:
+		BeginEdit();
+		return true;
+
+	case ERoomEditType::CommitEdit:
+		CommitEdit();
+		return true;
+
+	case ERoomEditType::Undo:
+		return Undo();
+
+	case ERoomEditType::Redo:
+		return Redo();
+
+	case ERoomEditType::FillWall:
+		if (!IsValid(wall))
+			return false;
+
+		FillWallWithObjects(wall, edit.Opening, edit.MeshIndex, edit.Count, edit.Value);
+		return true;
+	}
+
+	return false;
+}
+
+#if WITH_EDITOR
+void ARoom::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	const FName name = PropertyChangedEvent.GetPropertyName();
+
+	// Value is already set, components are switched to it
+	if (name == GET_MEMBER_NAME_CHECKED(ARoom, bUseInstancedSegments))
+		ApplySegmentMode();
 
-	return Box.Max - Box.Min;
+	if (name == GET_MEMBER_NAME_CHECKED(ARoom, WallUVSize))
+		ApplyWallUVSize();
 }
+#endif
 
 
@@ -0,0 +1,345 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RoomDescription.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "JsonObjectConverter.h"
+
+namespace
+{
+	// "DIRM", "DIFP" and "DIEL" in file order
+	const uint32 RoomMagic		= 0x4D524944;
+	const uint32 FloorPlanMagic = 0x50464944;
+	const uint32 EditLogMagic	= 0x4C454944;
+
+	// Increase when layout of saved data changes, older versions are still loaded.
+	// 2: polygon room outline
+	// 3: edit log keeps negative mesh index and count of recorded calls
+	const uint16 FormatVersion = 3;
+
+	// Return version of loaded data
+	uint16 SerializeHeader(FArchive& Ar, uint32 Magic)
+	{
+		uint32 magic   = Magic;
+		uint16 version = FormatVersion;
+
+		Ar << magic << version;
+
+		if (Ar.IsLoading() && (magic != Magic || version == 0 || version > FormatVersion))
+			Ar.SetError();
+
+		return version;
+	}
+
+	template<typename EnumType>
+	void SerializeEnum(FArchive& Ar, EnumType& Value, EnumType Max)
+	{
+		uint8 value = static_cast<uint8>(Value);
+		Ar << value;
+
+		if (!Ar.IsLoading())
+			return;
+
+		if (value > static_cast<uint8>(Max))
+			Ar.SetError();
+		else
+			Value = static_cast<EnumType>(value);
+	}
+
+	void SerializeIndex(FArchive& Ar, int32& Value)
+	{
+		// Negative index is a broken description, it is not saved as some other valid index
+		if (Ar.IsSaving() && Value < 0)
+		{
+			Ar.SetError();
+			return;
+		}
+
+		uint32 value = static_cast<uint32>(Value);
+		Ar.SerializeIntPacked(value);
+
+		if (Ar.IsLoading())
+			Value = static_cast<int32>(FMath::Min<uint32>(value, MAX_int32));
+	}
+
+	// Argument of recorded call, it may be any value the caller passed. Packed with sign in lowest bit.
+	void SerializeSignedIndex(FArchive& Ar, int32& Value)
+	{
+		uint32 value = (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+		Ar.SerializeIntPacked(value);
+
+		if (Ar.IsLoading())
+			Value = static_cast<int32>((value >> 1) ^ (0u - (value & 1u)));
+	}
+
+	// Wall and object of edit, INDEX_NONE is kept
+	void SerializeOptionalIndex(FArchive& Ar, int32& Value)
+	{
+		int32 value = Value + 1;
+		SerializeIndex(Ar, value);
+
+		if (Ar.IsLoading())
+			Value = value - 1;
+	}
+
+	// Count is checked against remaining bytes, so broken data cannot allocate huge arrays
+	template<typename ElementType, typename SerializeFunc>
+	void SerializeArray(FArchive& Ar, TArray<ElementType>& Array, int32 MinElementSize, SerializeFunc Serialize)
+	{
+		uint32 num = Array.Num();
+		Ar.SerializeIntPacked(num);
+
+		if (Ar.IsLoading())
+		{
+			if (Ar.IsError() || (int64)num * MinElementSize > Ar.TotalSize() - Ar.Tell())
+			{
+				Ar.SetError();
+				return;
+			}
+
+			Array.SetNum(num);
+		}
+
+		for (auto& Element : Array)
+		{
+			Serialize(Ar, Element);
+
+			if (Ar.IsError())
+				return;
+		}
+	}
+
+	void SerializeOpening(FArchive& Ar, FRoomOpeningDescription& Opening)
+	{
+		SerializeEnum(Ar, Opening.Type, ObjectType::WINDOW);
+		SerializeIndex(Ar, Opening.MeshIndex);
+		Ar << Opening.Offset;
+	}
+
+	void SerializeWall(FArchive& Ar, FRoomWallDescription& Wall)
+	{
+		SerializeArray(Ar, Wall.Openings, 6, SerializeOpening);
+	}
+
+	void SerializePoint(FArchive& Ar, FVector2D& Point)
+	{
+		Ar << Point;
+	}
+
+	void SerializeRoom(FArchive& Ar, FRoomDescription& Room)
+	{
+		const uint16 version = SerializeHeader(Ar, RoomMagic);
+		SerializeEnum(Ar, Room.Type, RoomType::POLYGON);
+
+		Ar << Room.Length << Room.Width << Room.Height << Room.CornerX << Room.CornerY;
+
+		if (version >= 2)
+			SerializeArray(Ar, Room.Outline, 8, SerializePoint);
+
+		SerializeArray(Ar, Room.Walls, 1, SerializeWall);
+	}
+
+	void SerializePlanRoom(FArchive& Ar, FBox2D& Room)
+	{
+		Ar << Room.Min << Room.Max;
+		Room.bIsValid = true;
+	}
+
+	void SerializePlanOpening(FArchive& Ar, FFloorPlanOpeningDescription& Opening)
+	{
+		EFloorPlanAxis axis = static_cast<EFloorPlanAxis>(Opening.Axis);
+		SerializeEnum(Ar, axis, EFloorPlanAxis::Y);
+		Opening.Axis = static_cast<uint8>(axis);
+
+		Ar << Opening.Line << Opening.Position;
+
+		SerializeEnum(Ar, Opening.Type, ObjectType::WINDOW);
+		SerializeIndex(Ar, Opening.MeshIndex);
+	}
+
+	void SerializeFloorPlan(FArchive& Ar, FFloorPlanDescription& Plan)
+	{
+		SerializeHeader(Ar, FloorPlanMagic);
+
+		Ar << Plan.Height;
+
+		SerializeArray(Ar, Plan.Rooms, 16, SerializePlanRoom);
+		SerializeArray(Ar, Plan.Openings, 11, SerializePlanOpening);
+	}
+
+	void SerializeEdit(FArchive& Ar, FRoomEdit& Edit, uint16 Version)
+	{
+		auto serializeArgument = Version >= 3 ? SerializeSignedIndex : SerializeIndex;
+
+		SerializeEnum(Ar, Edit.Type, ERoomEditType::FillWall);
+
+		Ar << Edit.Time << Edit.Duration;
+
+		switch (Edit.Type)
+		{
+		case ERoomEditType::CreateRoom:
+			SerializeEnum(Ar, Edit.Shape, RoomType::POLYGON);
+			break;
+
+		case ERoomEditType::AddObject:
+			SerializeOptionalIndex(Ar, Edit.Wall);
+			SerializeEnum(Ar, Edit.Opening, ObjectType::WINDOW);
+			serializeArgument(Ar, Edit.MeshIndex);
+			Ar << Edit.Value;
+			break;
+
+		case ERoomEditType::FillWall:
+			SerializeOptionalIndex(Ar, Edit.Wall);
+			SerializeEnum(Ar, Edit.Opening, ObjectType::WINDOW);
+			serializeArgument(Ar, Edit.MeshIndex);
+			serializeArgument(Ar, Edit.Count);
+			Ar << Edit.Value;
+			break;
+
+		case ERoomEditType::MoveObject:
+			SerializeOptionalIndex(Ar, Edit.Wall);
+			SerializeOptionalIndex(Ar, Edit.Object);
+			Ar << Edit.Value;
+			break;
+
+		case ERoomEditType::RemoveObject:
+			SerializeOptionalIndex(Ar, Edit.Wall);
+			SerializeOptionalIndex(Ar, Edit.Object);
+			break;
+
+		case ERoomEditType::SetCorner:
+			Ar << Edit.Point << Edit.bUpdateWalls;
+			break;
+
+		case ERoomEditType::SetLength:
+		case ERoomEditType::SetWidth:
+		case ERoomEditType::SetHeight:
+			Ar << Edit.Value;
+			break;
+
+		case ERoomEditType::UpdateWall:
+			SerializeOptionalIndex(Ar, Edit.Wall);
+			break;
+
+		case ERoomEditType::SetOutline:
+			SerializeArray(Ar, Edit.Outline, 8, SerializePoint);
+			break;
+
+		case ERoomEditType::BuildFromDescription:
+			SerializeRoom(Ar, Edit.Description);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	void SerializeEditLog(FArchive& Ar, FRoomEditLog& Log)
+	{
+		const uint16 version = SerializeHeader(Ar, EditLogMagic);
+
+		SerializeRoom(Ar, Log.Initial);
+		SerializeRoom(Ar, Log.Final);
+		SerializeArray(Ar, Log.Edits, 9, [version](FArchive& EditAr, FRoomEdit& Edit) { SerializeEdit(EditAr, Edit, version); });
+	}
+
+	template<typename DescriptionType, typename SerializeFunc>
+	bool SaveDescription(const DescriptionType& Description, TArray<uint8>& OutData, SerializeFunc Serialize)
+	{
+		OutData.Reset();
+
+		FMemoryWriter Writer(OutData);
+		Serialize(Writer, const_cast<DescriptionType&>(Description));
+
+		// Partly written data would load as a different description
+		if (Writer.IsError())
+		{
+			OutData.Reset();
+			return false;
+		}
+
+		return true;
+	}
+
+	template<typename DescriptionType, typename SerializeFunc>
+	bool LoadDescription(const TArray<uint8>& Data, DescriptionType& OutDescription, SerializeFunc Serialize)
+	{
+		// Read into temporary, so failed load keeps previous description
+		DescriptionType Description;
+
+		FMemoryReader Reader(Data);
+		Serialize(Reader, Description);
+
+		if (Reader.IsError() || !Reader.AtEnd())
+			return false;
+
+		OutDescription = MoveTemp(Description);
+		return true;
+	}
+}
+
+bool RoomDescription::Save(const FRoomDescription& Description, TArray<uint8>& OutData)
+{
+	return SaveDescription(Description, OutData, SerializeRoom);
+}
+
+bool RoomDescription::Load(const TArray<uint8>& Data, FRoomDescription& OutDescription)
+{
+	return LoadDescription(Data, OutDescription, SerializeRoom);
+}
+
+bool RoomDescription::Save(const FFloorPlanDescription& Description, TArray<uint8>& OutData)
+{
+	return SaveDescription(Description, OutData, SerializeFloorPlan);
+}
+
+bool RoomDescription::Load(const TArray<uint8>& Data, FFloorPlanDescription& OutDescription)
+{
+	return LoadDescription(Data, OutDescription, SerializeFloorPlan);
+}
+
+bool RoomDescription::Save(const FRoomEditLog& Log, TArray<uint8>& OutData)
+{
+	return SaveDescription(Log, OutData, SerializeEditLog);
+}
+
+bool RoomDescription::Load(const TArray<uint8>& Data, FRoomEditLog& OutLog)
+{
+	return LoadDescription(Data, OutLog, SerializeEditLog);
+}
+
+bool RoomDescription::ToJson(const FRoomDescription& Description, FString& OutJson)
+{
+	return FJsonObjectConverter::UStructToJsonObjectString(Description, OutJson);
+}
+
+bool RoomDescription::FromJson(const FString& Json, FRoomDescription& OutDescription)
+{
+	FRoomDescription Description;
+	if (!FJsonObjectConverter::JsonObjectStringToUStruct(Json, &Description, 0, 0))
+		return false;
+
+	OutDescription = MoveTemp(Description);
+	return true;
+}
+
+bool RoomDescription::ToJson(const FFloorPlanDescription& Description, FString& OutJson)
+{
+	return FJsonObjectConverter::UStructToJsonObjectString(Description, OutJson);
+}
+
+bool RoomDescription::FromJson(const FString& Json, FFloorPlanDescription& OutDescription)
+{
+	FFloorPlanDescription Description;
+	if (!FJsonObjectConverter::JsonObjectStringToUStruct(Json, &Description, 0, 0))
+		return false;
+
+	OutDescription = MoveTemp(Description);
+	return true;
+}
+
+bool RoomDescription::ToJson(const FRoomEditLog& Log, FString& OutJson)
+{
+	return FJsonObjectConverter::UStructToJsonObjectString(Log, OutJson);
+}
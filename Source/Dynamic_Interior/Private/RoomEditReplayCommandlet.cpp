@@ -0,0 +1,285 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RoomEditReplayCommandlet.h"
+#include "Room.h"
+#include "RoomDescription.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "GameFramework/WorldSettings.h"
+
+namespace
+{
+	const int32 NumEditTypes = static_cast<int32>(ERoomEditType::FillWall) + 1;
+
+	// Return percentile of sorted samples in microseconds
+	double GetPercentileUs(const TArray<uint64>& SortedCycles, double Percentile)
+	{
+		if (SortedCycles.Num() == 0)
+			return 0.0;
+
+		const int32 Index = FMath::Clamp((int32)(Percentile * (SortedCycles.Num() - 1)), 0, SortedCycles.Num() - 1);
+		return FPlatformTime::ToMilliseconds64(SortedCycles[Index]) * 1000.0;
+	}
+
+	uint64 SecondsToCycles(double Seconds)
+	{
+		return static_cast<uint64>(FMath::Max(Seconds, 0.0) / FPlatformTime::GetSecondsPerCycle64());
+	}
+}
+
+URoomEditReplayCommandlet::URoomEditReplayCommandlet()
+{
+	IsClient	 = false;
+	IsServer	 = false;
+	IsEditor	 = false;
+	LogToConsole = true;
+}
+
+int32 URoomEditReplayCommandlet::Main(const FString& Params)
+{
+	FString LogPath;
+	FString ClassPath;
+	int32 Repeat   = 1;
+	float BudgetUs = 0.0f;
+
+	FParse::Value(*Params, TEXT("logs="), LogPath);
+	FParse::Value(*Params, TEXT("class="), ClassPath);
+	FParse::Value(*Params, TEXT("repeat="), Repeat);
+	FParse::Value(*Params, TEXT("budgetus="), BudgetUs);
+
+	Repeat = FMath::Max(Repeat, 1);
+
+	if (LogPath.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("RoomEditReplay: -logs= must name edit log or directory with *.roomlog files."));
+		return 1;
+	}
+
+	// Sorted, so corpus is replayed in the same order on every run
+	TArray<FString> Files;
+	if (IFileManager::Get().DirectoryExists(*LogPath))
+	{
+		IFileManager::Get().FindFiles(Files, *(LogPath / TEXT("*.roomlog")), true, false);
+
+		for (auto& File : Files)
+			File = LogPath / File;
+
+		Files.Sort();
+	}
+	else
+	{
+		Files.Add(LogPath);
+	}
+
+	UClass* RoomClass = ARoom::StaticClass();
+	if (!ClassPath.IsEmpty())
+	{
+		RoomClass = LoadClass<ARoom>(nullptr, *ClassPath);
+		if (!RoomClass)
+		{
+			UE_LOG(LogTemp, Error, TEXT("RoomEditReplay: room class %s not found."), *ClassPath);
+			return 1;
+		}
+	}
+
+	// Default project meshes, same as BP_Room uses
+	auto WallMesh	 = LoadObject<UStaticMesh>(nullptr, TEXT("/Game/Meshes/Default_meshes/Geometries/Wall.Wall"));
+	auto FloorMesh	 = LoadObject<UStaticMesh>(nullptr, TEXT("/Game/Meshes/Default_meshes/Geometries/Floor.Floor"));
+	auto CeilingMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Game/Meshes/Default_meshes/Geometries/Ceiling.Ceiling"));
+	auto DoorMesh	 = LoadObject<UStaticMesh>(nullptr, TEXT("/Game/Meshes/Default_meshes/Geometries/Door.Door"));
+	auto WindowMesh	 = LoadObject<UStaticMesh>(nullptr, TEXT("/Game/Meshes/Default_meshes/Geometries/Window.Window"));
+
+	if (RoomClass == ARoom::StaticClass() && (!WallMesh || !FloorMesh || !CeilingMesh || !DoorMesh || !WindowMesh))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RoomEditReplay: default meshes not found."));
+		return 1;
+	}
+
+	// Transient game world without rendering
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("RoomEditReplay"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	// World has no game mode to start play, rooms spawned after this begin play in FinishSpawning
+	World->GetWorldSettings()->NotifyBeginPlay();
+
+	// Room is created in BeginPlay, so it is returned before FinishSpawning
+	auto spawnRoom = [&]()
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.bDeferConstruction = true;
+
+		ARoom* Room = World->SpawnActor<ARoom>(RoomClass, FTransform::Identity, SpawnParams);
+
+		// Every edit is measured with its rebuild
+		Room->bCoalesceEdits		   = false;
+		Room->bAsyncLayout			   = false;
+		Room->bProgressiveConstruction = false;
+		Room->bUseDistanceLOD		   = false;
+		Room->bRecordEdits			   = false;
+
+		if (RoomClass != ARoom::StaticClass())
+			return Room;
+
+		Room->WallMesh		= WallMesh;
+		Room->FloorMesh		= FloorMesh;
+		Room->CeilingMesh	= CeilingMesh;
+		Room->DoorMeshes	= { DoorMesh };
+		Room->WindowMeshes	= { WindowMesh };
+
+		// Native room has no root, blueprint adds one
+		auto Root = NewObject<USceneComponent>(Room, TEXT("Root"));
+		Room->SetRootComponent(Root);
+		Root->RegisterComponent();
+
+		return Room;
+	};
+
+	TArray<TArray<uint64>> ReplayedCycles;
+	TArray<TArray<uint64>> RecordedCycles;
+	ReplayedCycles.SetNum(NumEditTypes);
+	RecordedCycles.SetNum(NumEditTypes);
+
+	TArray<uint64> SpawnCycles;
+
+	int32 NumSkipped = 0;
+	FString Failure;
+
+	for (const auto& File : Files)
+	{
+		TArray<uint8> Data;
+		FRoomEditLog Log;
+
+		if (!FFileHelper::LoadFileToArray(Data, *File) || !RoomDescription::Load(Data, Log))
+		{
+			Failure = FString::Printf(TEXT("%s is not a room edit log"), *File);
+			break;
+		}
+
+		TArray<uint8> Expected;
+		RoomDescription::Save(Log.Final, Expected);
+
+		const float SessionSeconds = Log.Edits.Num() > 0 ? Log.Edits.Last().Time + Log.Edits.Last().Duration : 0.0f;
+		uint64 LogCycles = 0;
+
+		for (int32 rep = 0; rep < Repeat && Failure.IsEmpty(); ++rep)
+		{
+			ARoom* Room = spawnRoom();
+			Room->BuildFromDescription(Log.Initial);
+
+			const uint64 SpawnStart = FPlatformTime::Cycles64();
+			Room->FinishSpawning(FTransform::Identity);
+			const uint64 Spawned = FPlatformTime::Cycles64() - SpawnStart;
+
+			if (!Room->HasActorBegunPlay() || Room->Walls.Num() == 0)
+			{
+				Failure = FString::Printf(TEXT("%s: room was not created"), *File);
+				Room->Destroy();
+				break;
+			}
+
+			// Log recorded from begin play starts with room creation, which FinishSpawning has done
+			int32 First = 0;
+			if (Log.Initial.Walls.Num() == 0 && Log.Edits.Num() > 0 && Log.Edits[0].Type == ERoomEditType::CreateRoom)
+			{
+				ReplayedCycles[static_cast<int32>(ERoomEditType::CreateRoom)].Add(Spawned);
+				First = 1;
+			}
+			else
+			{
+				SpawnCycles.Add(Spawned);
+			}
+
+			for (int32 idx = First; idx < Log.Edits.Num(); ++idx)
+			{
+				const FRoomEdit& Edit = Log.Edits[idx];
+
+				const uint64 EditStart = FPlatformTime::Cycles64();
+				const bool bReplayed = Room->ReplayEdit(Edit);
+				const uint64 EditCycles = FPlatformTime::Cycles64() - EditStart;
+
+				// Recorded call did nothing as well, final room comparison catches real divergence
+				if (!bReplayed)
+				{
+					NumSkipped++;
+					continue;
+				}
+
+				ReplayedCycles[static_cast<int32>(Edit.Type)].Add(EditCycles);
+				LogCycles += EditCycles;
+			}
+
+			TArray<uint8> Actual;
+			Room->SaveToBytes(Actual);
+
+			if (Actual != Expected)
+				Failure = FString::Printf(TEXT("%s: replay does not end in recorded room"), *File);
+
+			Room->Destroy();
+		}
+
+		for (const auto& Edit : Log.Edits)
+			RecordedCycles[static_cast<int32>(Edit.Type)].Add(SecondsToCycles(Edit.Duration));
+
+		UE_LOG(LogTemp, Display, TEXT("RoomEditReplay: %s, %d edits over %.1f s of session, replayed in %.3f ms"),
+			*FPaths::GetCleanFilename(File), Log.Edits.Num(), SessionSeconds, FPlatformTime::ToMilliseconds64(LogCycles) / Repeat);
+
+		if (!Failure.IsEmpty())
+			break;
+	}
+
+	World->DestroyWorld(false);
+	GEngine->DestroyWorldContext(World);
+
+	const UEnum* EditEnum = StaticEnum<ERoomEditType>();
+
+	for (int32 type = 0; type < NumEditTypes; ++type)
+	{
+		auto& Replayed = ReplayedCycles[type];
+		auto& Recorded = RecordedCycles[type];
+
+		if (Replayed.Num() == 0 && Recorded.Num() == 0)
+			continue;
+
+		Replayed.Sort();
+		Recorded.Sort();
+
+		const double P99Us = GetPercentileUs(Replayed, 0.99);
+
+		UE_LOG(LogTemp, Display, TEXT("RoomEditReplay: %-20s %6d edits, p50 %9.3f us, p99 %9.3f us, max %9.3f us, recorded p50 %9.3f us, p99 %9.3f us"),
+			*EditEnum->GetNameStringByValue(type), Replayed.Num(), GetPercentileUs(Replayed, 0.5), P99Us, GetPercentileUs(Replayed, 1.0),
+			GetPercentileUs(Recorded, 0.5), GetPercentileUs(Recorded, 0.99));
+
+		if (Failure.IsEmpty() && BudgetUs > 0.0f && P99Us > BudgetUs)
+			Failure = FString::Printf(TEXT("%s p99 %.3f us exceeds budget %.3f us"), *EditEnum->GetNameStringByValue(type), P99Us, BudgetUs);
+	}
+
+	if (SpawnCycles.Num() > 0)
+	{
+		SpawnCycles.Sort();
+
+		UE_LOG(LogTemp, Display, TEXT("RoomEditReplay: %d rooms spawned from initial state, p50 %.3f us, max %.3f us"),
+			SpawnCycles.Num(), GetPercentileUs(SpawnCycles, 0.5), GetPercentileUs(SpawnCycles, 1.0));
+	}
+
+	if (NumSkipped > 0)
+		UE_LOG(LogTemp, Warning, TEXT("RoomEditReplay: %d edits refer to missing wall or object and were skipped"), NumSkipped);
+
+	if (!Failure.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("RoomEditReplay: %s"), *Failure);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,1118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RoomLayout.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+	// Return minimal wall length required by the last opening on wall
+	float GetRequiredLength(const FWallLayoutInput& Wall, float AligmentOffset)
+	{
+		if (Wall.Openings.Num() == 0)
+			return 0.0f;
+
+		return Wall.Openings.GetEnd(Wall.Openings.Num() - 1) + AligmentOffset;
+	}
+
+	// Add quad with vertices in cyclic order, winding is fixed up to face along normal
+	void AddQuad(FWallMeshData& Mesh, const FVector (&Points)[4], const FVector2D (&UVs)[4], const FVector& Normal)
+	{
+		const int32 Base = Mesh.Vertices.Num();
+		const bool bReverse = (((Points[1] - Points[0]) ^ (Points[3] - Points[0])) | Normal) > 0.0f;
+
+		// Reverse vertices instead of indices, so index buffer depends only on quad count
+		for (int32 idx = 0; idx < 4; ++idx)
+		{
+			const int32 Src = bReverse ? 3 - idx : idx;
+
+			Mesh.Vertices.Add(Points[Src]);
+			Mesh.UVs.Add(UVs[Src]);
+			Mesh.Normals.Add(Normal);
+		}
+
+		Mesh.Triangles.Add(Base + 0);
+		Mesh.Triangles.Add(Base + 1);
+		Mesh.Triangles.Add(Base + 3);
+		Mesh.Triangles.Add(Base + 1);
+		Mesh.Triangles.Add(Base + 2);
+		Mesh.Triangles.Add(Base + 3);
+	}
+
+	// Quad on wall face X = const, Y/Z rectangle
+	void AddFaceQuad(FWallMeshData& Mesh, float X, float Y0, float Y1, float Z0, float Z1, float NormalX, float UVSize)
+	{
+		if (Y1 - Y0 <= KINDA_SMALL_NUMBER || Z1 - Z0 <= KINDA_SMALL_NUMBER)
+			return;
+
+		const FVector Points[4] = { FVector(X, Y0, Z0), FVector(X, Y1, Z0), FVector(X, Y1, Z1), FVector(X, Y0, Z1) };
+		const FVector2D UVs[4] = { FVector2D(Y0, -Z0) / UVSize, FVector2D(Y1, -Z0) / UVSize, FVector2D(Y1, -Z1) / UVSize, FVector2D(Y0, -Z1) / UVSize };
+
+		AddQuad(Mesh, Points, UVs, FVector(NormalX, 0.0f, 0.0f));
+	}
+
+	// Quad on plane Y = const across wall thickness
+	void AddSideQuad(FWallMeshData& Mesh, float Y, float Thickness, float Z0, float Z1, float NormalY, float UVSize)
+	{
+		if (Z1 - Z0 <= KINDA_SMALL_NUMBER)
+			return;
+
+		const FVector Points[4] = { FVector(0.0f, Y, Z0), FVector(Thickness, Y, Z0), FVector(Thickness, Y, Z1), FVector(0.0f, Y, Z1) };
+		const FVector2D UVs[4] = { FVector2D(0.0f, -Z0) / UVSize, FVector2D(Thickness, -Z0) / UVSize, FVector2D(Thickness, -Z1) / UVSize, FVector2D(0.0f, -Z1) / UVSize };
+
+		AddQuad(Mesh, Points, UVs, FVector(0.0f, NormalY, 0.0f));
+	}
+
+	// Quad on plane Z = const across wall thickness
+	void AddCapQuad(FWallMeshData& Mesh, float Z, float Thickness, float Y0, float Y1, float NormalZ, float UVSize)
+	{
+		if (Y1 - Y0 <= KINDA_SMALL_NUMBER)
+			return;
+
+		const FVector Points[4] = { FVector(0.0f, Y0, Z), FVector(Thickness, Y0, Z), FVector(Thickness, Y1, Z), FVector(0.0f, Y1, Z) };
+		const FVector2D UVs[4] = { FVector2D(Y0, 0.0f) / UVSize, FVector2D(Y0, Thickness) / UVSize, FVector2D(Y1, Thickness) / UVSize, FVector2D(Y1, 0.0f) / UVSize };
+
+		AddQuad(Mesh, Points, UVs, FVector(0.0f, 0.0f, NormalZ));
+	}
+
+	FSegmentTransform MakeSegment(const FVector& Location, const FVector& Scale)
+	{
+		FSegmentTransform Segment;
+		Segment.Location = Location;
+		Segment.Scale	 = Scale;
+		return Segment;
+	}
+
+	bool IsAlongX(const FVector2D& A, const FVector2D& B)
+	{
+		return FMath::Abs(B.X - A.X) > FMath::Abs(B.Y - A.Y);
+	}
+
+	bool IsAxisAligned(const FVector2D& A, const FVector2D& B)
+	{
+		return FMath::IsNearlyEqual(A.X, B.X) != FMath::IsNearlyEqual(A.Y, B.Y);
+	}
+
+	FBox2D GetEdgeBox(const FVector2D& A, const FVector2D& B)
+	{
+		return FBox2D(FVector2D(FMath::Min(A.X, B.X), FMath::Min(A.Y, B.Y)), FVector2D(FMath::Max(A.X, B.X), FMath::Max(A.Y, B.Y)));
+	}
+
+	// 1 if outline goes counterclockwise with X right and Y up, -1 otherwise
+	float GetWinding(TArrayView<const FVector2D> Points)
+	{
+		float Area = 0.0f;
+		for (int32 idx = 0; idx < Points.Num(); ++idx)
+			Area += Points[idx] ^ Points[(idx + 1) % Points.Num()];
+
+		return Area >= 0.0f ? 1.0f : -1.0f;
+	}
+
+	// Unit normal of axis aligned edge pointing out of the room
+	FVector2D GetOutwardNormal(const FVector2D& A, const FVector2D& B, float Winding)
+	{
+		const FVector2D Direction = B - A;
+
+		if (IsAlongX(A, B))
+			return FVector2D(0.0f, Direction.X > 0.0f ? -Winding : Winding);
+
+		return FVector2D(Direction.Y > 0.0f ? Winding : -Winding, 0.0f);
+	}
+
+}
+
+int32 RoomLayout::GetNumWalls(const FRoomLayoutSettings& Settings)
+{
+	switch (Settings.Shape)
+	{
+	case ELayoutRoomShape::LShape:
+		return 6;
+	case ELayoutRoomShape::Polygon:
+		return Settings.Outline.Num();
+	default:
+		return 4;
+	}
+}
+
+void RoomLayout::BuildOutline(const FRoomLayoutSettings& Settings, FRoomOutline& OutOutline)
+{
+	OutOutline.Points.Reset();
+	OutOutline.WallIndices.Reset();
+
+	const float Length  = Settings.Length;
+	const float Width   = Settings.Width;
+	const float CornerX = Settings.CornerX;
+	const float CornerY = Settings.CornerY;
+
+	// Fixed shapes keep their wall indices, so saved rooms and WallDirection stay valid
+	if (Settings.Shape == ELayoutRoomShape::Standard)
+	{
+		OutOutline.Points.Append({ FVector2D(0.0f, 0.0f), FVector2D(Length, 0.0f), FVector2D(Length, Width), FVector2D(0.0f, Width) });
+		OutOutline.WallIndices.Append({ RoomWallIndex::West, RoomWallIndex::North, RoomWallIndex::East, RoomWallIndex::South });
+	}
+	else if (Settings.Shape == ELayoutRoomShape::LShape)
+	{
+		OutOutline.Points.Append({ FVector2D(0.0f, 0.0f), FVector2D(Length, 0.0f), FVector2D(Length, CornerY),
+			FVector2D(CornerX, CornerY), FVector2D(CornerX, Width), FVector2D(0.0f, Width) });
+		OutOutline.WallIndices.Append({ RoomWallIndex::West, RoomWallIndex::North, RoomWallIndex::NorthEast,
+			RoomWallIndex::SouthEast, RoomWallIndex::East, RoomWallIndex::South });
+	}
+	else
+	{
+		OutOutline.Points = Settings.Outline;
+
+		OutOutline.WallIndices.SetNumUninitialized(Settings.Outline.Num());
+		for (int32 idx = 0; idx < Settings.Outline.Num(); ++idx)
+			OutOutline.WallIndices[idx] = idx;
+	}
+}
+
+bool RoomLayout::ValidateOutline(const FRoomLayoutSettings& Settings, TArrayView<const FVector2D> Points, FString& OutError)
+{
+	const int32 Num = Points.Num();
+
+	// Axis aligned outline turns at every point, so it has even count of points
+	if (Num < 4 || Num % 2 != 0)
+	{
+		OutError = FString::Printf(TEXT("outline has %d points, expected even count of at least 4"), Num);
+		return false;
+	}
+
+	for (int32 idx = 0; idx < Num; ++idx)
+	{
+		const FVector2D& A = Points[idx];
+		const FVector2D& B = Points[(idx + 1) % Num];
+		const FVector2D& C = Points[(idx + 2) % Num];
+
+		if (!IsAxisAligned(A, B))
+		{
+			OutError = FString::Printf(TEXT("edge %d is not axis aligned"), idx);
+			return false;
+		}
+
+		if (IsAlongX(A, B) == IsAlongX(B, C))
+		{
+			OutError = FString::Printf(TEXT("edges %d and %d do not turn at point %d"), idx, (idx + 1) % Num, (idx + 1) % Num);
+			return false;
+		}
+
+		// Both ends may be cut back by a wall thickness at inner corners
+		if ((B - A).GetAbsMax() <= Settings.WallOffset * 2.0f)
+		{
+			OutError = FString::Printf(TEXT("edge %d is %.2f long, shorter than two wall thicknesses"), idx, (B - A).GetAbsMax());
+			return false;
+		}
+	}
+
+	// Edges which are not neighbours must not touch
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const FBox2D EdgeI = GetEdgeBox(Points[i], Points[(i + 1) % Num]);
+
+		for (int32 j = i + 2; j < Num; ++j)
+		{
+			if (i == 0 && j == Num - 1)
+				continue;
+
+			const FBox2D EdgeJ = GetEdgeBox(Points[j], Points[(j + 1) % Num]);
+
+			if (EdgeI.Min.X <= EdgeJ.Max.X && EdgeJ.Min.X <= EdgeI.Max.X && EdgeI.Min.Y <= EdgeJ.Max.Y && EdgeJ.Min.Y <= EdgeI.Max.Y)
+			{
+				OutError = FString::Printf(TEXT("edges %d and %d intersect"), i, j);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void RoomLayout::GetSegmentCounts(const FWallOpenings& Openings, int32& OutHorizontal, int32& OutVertical)
+{
+	OutHorizontal = Openings.Num() + 1;
+	OutVertical = 0;
+
+	// Door has segment above, window above and below
+	for (ELayoutOpeningType Type : Openings.Types)
+		OutVertical += Type == ELayoutOpeningType::Window ? 2 : 1;
+}
+
+void RoomLayout::ComputeWallPlacements(const FRoomLayoutSettings& Settings, TArray<FWallPlacement>& OutPlacements)
+{
+	FRoomOutline Outline;
+	BuildOutline(Settings, Outline);
+
+	const TArray<FVector2D>& Points = Outline.Points;
+	const int32 Num = Points.Num();
+	const float Winding = GetWinding(Points);
+	const float WallOffset = Settings.WallOffset;
+
+	OutPlacements.SetNum(Num);
+
+	for (int32 idx = 0; idx < Num; ++idx)
+	{
+		const FVector2D& Prev = Points[(idx + Num - 1) % Num];
+		const FVector2D& A	  = Points[idx];
+		const FVector2D& B	  = Points[(idx + 1) % Num];
+		const FVector2D& Next = Points[(idx + 2) % Num];
+
+		const FVector2D Normal = GetOutwardNormal(A, B, Winding);
+
+		// Walls always run along +X or +Y, so wall start may be at either end of the edge
+		const int32 Axis = IsAlongX(A, B) ? 0 : 1;
+		const bool bForward = A[Axis] <= B[Axis];
+
+		const FVector2D StartNormal = GetOutwardNormal(bForward ? Prev : B, bForward ? A : Next, Winding);
+		const FVector2D EndNormal	= GetOutwardNormal(bForward ? B : Prev, bForward ? Next : A, Winding);
+
+		// At inner corners the neighbour wall passes over the edge end, corner square is left for corner segment
+		float Start = FMath::Min(A[Axis], B[Axis]);
+		float End	= FMath::Max(A[Axis], B[Axis]);
+
+		if (StartNormal[Axis] > 0.0f)
+			Start += WallOffset;
+
+		if (EndNormal[Axis] < 0.0f)
+			End -= WallOffset;
+
+		const float Line = A[1 - Axis];
+
+		FWallPlacement& Placement = OutPlacements[Outline.WallIndices[idx]];
+		Placement = FWallPlacement();
+		Placement.Length = FMath::Max(End - Start, 0.0f);
+
+		// Bounding box covers whole wall
+		Placement.Bounds.Location = FVector(Settings.AligmentOffset / 2.0f, Placement.Length / 2.0f, Settings.Height / 2.0f);
+		Placement.Bounds.Scale	  = FVector(Settings.AligmentOffset + 0.001f, Placement.Length, Settings.Height * 1.3f) / 100.0f;
+
+		// Wall thickness goes along local X, which is +X for yaw 0 and -Y for yaw -90.
+		// Walls with thickness against the outside normal are shifted by it and show objects flipped.
+		if (Axis == 1)
+		{
+			Placement.bFlipObjects = Normal.X < 0.0f;
+			Placement.Location = FVector(Placement.bFlipObjects ? Line - WallOffset : Line, Start, 0.0f);
+		}
+		else
+		{
+			Placement.Yaw = -90.0f;
+			Placement.bFlipObjects = Normal.Y > 0.0f;
+			Placement.Location = FVector(Start, Placement.bFlipObjects ? Line + WallOffset : Line, 0.0f);
+		}
+	}
+}
+
+bool RoomLayout::HaveSameSegmentParameters(const FRoomLayoutSettings& A, const FRoomLayoutSettings& B)
+{
+	return A.Height == B.Height
+		&& A.WallOffset == B.WallOffset
+		&& A.DoorOffset == B.DoorOffset
+		&& A.WindowOffset == B.WindowOffset
+		&& A.WindowHeightOffset == B.WindowHeightOffset;
+}
+
+void RoomLayout::SolveWall(const FRoomLayoutSettings& Settings, const FWallPlacement& Placement, const FWallOpenings& Openings, FWallLayout& OutLayout)
+{
+	const float Height = Settings.Height;
+
+	int32 NumHorizontal = 0;
+	int32 NumVertical = 0;
+	GetSegmentCounts(Openings, NumHorizontal, NumVertical);
+
+	OutLayout.HorizontalSegments.Reset(NumHorizontal);
+	OutLayout.VerticalSegments.Reset(NumVertical);
+	OutLayout.Openings.Reset(Openings.Num());
+
+	const float* Offsets = Openings.Offsets.GetData();
+	const float* Widths	 = Openings.Widths.GetData();
+	const float* Heights = Openings.Heights.GetData();
+	const ELayoutOpeningType* Types = Openings.Types.GetData();
+	const int32 Num = Openings.Num();
+
+	// Horizontal segments fill the space between objects
+	float CurrentOffset = 0.0f;
+	for (int32 idx = 0; idx < Num; ++idx)
+	{
+		OutLayout.HorizontalSegments.Add(MakeSegment(FVector(0.0f, CurrentOffset, 0.0f), FVector(1.0f, Offsets[idx] - CurrentOffset, Height)));
+		CurrentOffset = Offsets[idx] + Widths[idx];
+	}
+
+	OutLayout.HorizontalSegments.Add(MakeSegment(FVector(0.0f, CurrentOffset, 0.0f), FVector(1.0f, Placement.Length - CurrentOffset, Height)));
+
+	// Vertical segments fill the space above and below objects
+	for (int32 idx = 0; idx < Num; ++idx)
+	{
+		if (Types[idx] == ELayoutOpeningType::Door)
+		{
+			OutLayout.VerticalSegments.Add(MakeSegment(FVector(0.0f, Offsets[idx], Heights[idx]), FVector(1.0f, Widths[idx], Height - Heights[idx])));
+		}
+		else if (Types[idx] == ELayoutOpeningType::Window)
+		{
+			const float TopZ = Settings.WindowHeightOffset + Heights[idx];
+
+			OutLayout.VerticalSegments.Add(MakeSegment(FVector(0.0f, Offsets[idx], 0.0f), FVector(1.0f, Widths[idx], Settings.WindowHeightOffset)));
+			OutLayout.VerticalSegments.Add(MakeSegment(FVector(0.0f, Offsets[idx], TopZ), FVector(1.0f, Widths[idx], Height - TopZ)));
+		}
+	}
+
+	// Object transforms, rotated by 180 degrees if needed
+	const float Yaw	  = Placement.bFlipObjects ? 180.0f : 0.0f;
+	const float FlipX = Placement.bFlipObjects ? Settings.WallOffset / 2.0f : 0.0f;
+
+	OutLayout.Openings.SetNumUninitialized(Num);
+	for (int32 idx = 0; idx < Num; ++idx)
+	{
+		const bool bDoor = Types[idx] == ELayoutOpeningType::Door;
+		const float FlipY = Placement.bFlipObjects ? Widths[idx] : 0.0f;
+
+		FOpeningPlacement& Object = OutLayout.Openings[idx];
+		Object.Location = FVector((bDoor ? Settings.DoorOffset : Settings.WindowOffset) + FlipX, Offsets[idx] + FlipY, bDoor ? 0.0f : Settings.WindowHeightOffset);
+		Object.Yaw = Yaw;
+	}
+}
+
+void RoomLayout::BuildWallMesh(const FRoomLayoutSettings& Settings, const FWallPlacement& Placement, const FWallOpenings& Openings, const FWallLayout& Layout, float UVSize, FWallMeshData& OutMesh)
+{
+	const float Thickness = Settings.WallOffset;
+	const float Height	  = Settings.Height;
+	const float Length	  = Placement.Length;
+
+	UVSize = FMath::Max(UVSize, 1.0f);
+
+	// Front and back faces, 4 vertices per quad
+	const int32 NumRects = Layout.HorizontalSegments.Num() + Layout.VerticalSegments.Num();
+	const int32 NumQuads = NumRects * 2 + Openings.Num() * 4 + 3;
+
+	OutMesh.Vertices.Reset(NumQuads * 4);
+	OutMesh.Normals.Reset(NumQuads * 4);
+	OutMesh.UVs.Reset(NumQuads * 4);
+	OutMesh.Triangles.Reset(NumQuads * 6);
+
+	// Segments tile the solid part of the wall, they become faces of one mesh
+	auto addFaces = [&](const TArray<FSegmentTransform>& Segments)
+	{
+		for (const auto& Segment : Segments)
+		{
+			const float Y0 = Segment.Location.Y;
+			const float Y1 = Y0 + Segment.Scale.Y;
+			const float Z0 = Segment.Location.Z;
+			const float Z1 = Z0 + Segment.Scale.Z;
+
+			AddFaceQuad(OutMesh, 0.0f, Y0, Y1, Z0, Z1, -1.0f, UVSize);
+			AddFaceQuad(OutMesh, Thickness, Y0, Y1, Z0, Z1, 1.0f, UVSize);
+		}
+	};
+
+	addFaces(Layout.HorizontalSegments);
+	addFaces(Layout.VerticalSegments);
+
+	// Opening reveals
+	for (int32 idx = 0; idx < Openings.Num(); ++idx)
+	{
+		const bool bWindow = Openings.Types[idx] == ELayoutOpeningType::Window;
+		const float Y0 = Openings.Offsets[idx];
+		const float Y1 = Openings.GetEnd(idx);
+		const float Z0 = bWindow ? Settings.WindowHeightOffset : 0.0f;
+		const float Z1 = Z0 + Openings.Heights[idx];
+
+		AddSideQuad(OutMesh, Y0, Thickness, Z0, Z1, 1.0f, UVSize);
+		AddSideQuad(OutMesh, Y1, Thickness, Z0, Z1, -1.0f, UVSize);
+		AddCapQuad(OutMesh, Z1, Thickness, Y0, Y1, -1.0f, UVSize);
+
+		// Door reveal ends on the floor
+		if (bWindow)
+			AddCapQuad(OutMesh, Z0, Thickness, Y0, Y1, 1.0f, UVSize);
+	}
+
+	// Wall ends and top
+	AddSideQuad(OutMesh, 0.0f, Thickness, 0.0f, Height, -1.0f, UVSize);
+	AddSideQuad(OutMesh, Length, Thickness, 0.0f, Height, 1.0f, UVSize);
+	AddCapQuad(OutMesh, Height, Thickness, 0.0f, Length, 1.0f, UVSize);
+}
+
+void RoomLayout::BuildMergedWallMesh(const FRoomLayoutSettings& Settings, TArrayView<const FWallPlacement> Placements, float UVSize, FWallMeshData& OutMesh)
+{
+	OutMesh.Vertices.Reset();
+	OutMesh.Normals.Reset();
+	OutMesh.UVs.Reset();
+	OutMesh.Triangles.Reset();
+
+	const FWallOpenings NoOpenings;
+	FWallLayout Layout;
+	FWallMeshData Wall;
+
+	for (const auto& Placement : Placements)
+	{
+		// Wall without openings is one segment, its mesh is moved from wall to room space
+		SolveWall(Settings, Placement, NoOpenings, Layout);
+		BuildWallMesh(Settings, Placement, NoOpenings, Layout, UVSize, Wall);
+
+		const FRotator Rotation(0.0f, Placement.Yaw, 0.0f);
+		const int32 Base = OutMesh.Vertices.Num();
+
+		for (const auto& Vertex : Wall.Vertices)
+			OutMesh.Vertices.Add(Rotation.RotateVector(Vertex) + Placement.Location);
+
+		for (const auto& Normal : Wall.Normals)
+			OutMesh.Normals.Add(Rotation.RotateVector(Normal));
+
+		for (int32 Index : Wall.Triangles)
+			OutMesh.Triangles.Add(Base + Index);
+
+		OutMesh.UVs.Append(Wall.UVs);
+	}
+}
+
+bool RoomLayout::IntersectWall(const FRoomLayoutSettings& Settings, const FWallPlacement& Placement, const FVector& Origin, const FVector& Direction, float& OutDistance, FVector& OutLocalHit)
+{
+	const FRotator Rotation(0.0f, Placement.Yaw, 0.0f);
+
+	const FVector LocalOrigin	 = Rotation.UnrotateVector(Origin - Placement.Location);
+	const FVector LocalDirection = Rotation.UnrotateVector(Direction);
+
+	// Wall box in wall space, same as segments and wall mesh
+	const FVector Min(0.0f);
+	const FVector Max(Settings.WallOffset, Placement.Length, Settings.Height);
+
+	float Near = 0.0f;
+	float Far  = MAX_flt;
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const float O = LocalOrigin[Axis];
+		const float D = LocalDirection[Axis];
+
+		// Parallel ray misses unless it runs inside the slab
+		if (FMath::Abs(D) < SMALL_NUMBER)
+		{
+			if (O < Min[Axis] || O > Max[Axis])
+				return false;
+
+			continue;
+		}
+
+		float T0 = (Min[Axis] - O) / D;
+		float T1 = (Max[Axis] - O) / D;
+
+		if (T0 > T1)
+			Swap(T0, T1);
+
+		Near = FMath::Max(Near, T0);
+		Far	 = FMath::Min(Far, T1);
+
+		if (Near > Far)
+			return false;
+	}
+
+	OutDistance = Near;
+	OutLocalHit = LocalOrigin + LocalDirection * Near;
+
+	return true;
+}
+
+bool RoomLayout::ValidateWallLayout(const FRoomLayoutSettings& Settings, const FWallPlacement& Placement, const FWallOpenings& Openings, const FWallLayout& Layout, FString& OutError)
+{
+	const float Tolerance = 0.01f;
+	const float Height = Settings.Height;
+
+	int32 NumHorizontal = 0;
+	int32 NumVertical = 0;
+	GetSegmentCounts(Openings, NumHorizontal, NumVertical);
+
+	if (Layout.HorizontalSegments.Num() != NumHorizontal || Layout.VerticalSegments.Num() != NumVertical || Layout.Openings.Num() != Openings.Num())
+	{
+		OutError = FString::Printf(TEXT("%d horizontal, %d vertical segments and %d objects, expected %d, %d and %d"),
+			Layout.HorizontalSegments.Num(), Layout.VerticalSegments.Num(), Layout.Openings.Num(), NumHorizontal, NumVertical, Openings.Num());
+		return false;
+	}
+
+	// Segment must cover exactly the expected rectangle
+	auto checkSegment = [&](const TCHAR* Kind, int32 Index, const FSegmentTransform& Segment, float Y0, float Y1, float Z0, float Z1)
+	{
+		const float SegmentY1 = Segment.Location.Y + Segment.Scale.Y;
+		const float SegmentZ1 = Segment.Location.Z + Segment.Scale.Z;
+
+		if (FMath::IsNearlyEqual(Segment.Location.Y, Y0, Tolerance) && FMath::IsNearlyEqual(SegmentY1, Y1, Tolerance)
+			&& FMath::IsNearlyEqual(Segment.Location.Z, Z0, Tolerance) && FMath::IsNearlyEqual(SegmentZ1, Z1, Tolerance))
+			return true;
+
+		OutError = FString::Printf(TEXT("%s segment %d covers Y [%.2f, %.2f] Z [%.2f, %.2f], expected Y [%.2f, %.2f] Z [%.2f, %.2f]"),
+			Kind, Index, Segment.Location.Y, SegmentY1, Segment.Location.Z, SegmentZ1, Y0, Y1, Z0, Z1);
+		return false;
+	};
+
+	// Openings are sorted, inside the wall and do not overlap
+	float Cursor = 0.0f;
+	for (int32 idx = 0; idx < Openings.Num(); ++idx)
+	{
+		if (Openings.Widths[idx] < 0.0f || Openings.Offsets[idx] < Cursor - Tolerance || Openings.GetEnd(idx) > Placement.Length + Tolerance)
+		{
+			OutError = FString::Printf(TEXT("opening %d [%.2f, %.2f] overlaps previous opening or wall end (wall length %.2f)"),
+				idx, Openings.Offsets[idx], Openings.GetEnd(idx), Placement.Length);
+			return false;
+		}
+
+		Cursor = Openings.GetEnd(idx);
+	}
+
+	// Horizontal segments fill the space between openings
+	Cursor = 0.0f;
+	for (int32 idx = 0; idx < NumHorizontal; ++idx)
+	{
+		const float End = idx < Openings.Num() ? Openings.Offsets[idx] : Placement.Length;
+
+		if (!checkSegment(TEXT("Horizontal"), idx, Layout.HorizontalSegments[idx], Cursor, End, 0.0f, Height))
+			return false;
+
+		if (idx < Openings.Num())
+			Cursor = Openings.GetEnd(idx);
+	}
+
+	// Vertical segments fill the space above and below openings
+	int32 Vertical = 0;
+	for (int32 idx = 0; idx < Openings.Num(); ++idx)
+	{
+		const float Y0 = Openings.Offsets[idx];
+		const float Y1 = Openings.GetEnd(idx);
+
+		if (Openings.Types[idx] == ELayoutOpeningType::Door)
+		{
+			if (!checkSegment(TEXT("Vertical"), Vertical, Layout.VerticalSegments[Vertical], Y0, Y1, Openings.Heights[idx], Height))
+				return false;
+
+			Vertical++;
+		}
+		else
+		{
+			const float TopZ = Settings.WindowHeightOffset + Openings.Heights[idx];
+
+			if (!checkSegment(TEXT("Vertical"), Vertical, Layout.VerticalSegments[Vertical], Y0, Y1, 0.0f, Settings.WindowHeightOffset))
+				return false;
+
+			if (!checkSegment(TEXT("Vertical"), Vertical + 1, Layout.VerticalSegments[Vertical + 1], Y0, Y1, TopZ, Height))
+				return false;
+
+			Vertical += 2;
+		}
+	}
+
+	return true;
+}
+
+int32 RoomLayout::FindOpeningAfter(const FWallOpenings& Openings, float Position)
+{
+	return Algo::UpperBound(Openings.Offsets, Position);
+}
+
+bool RoomLayout::FindFreeSlot(const FWallOpenings& Openings, float WallLength, float Aligment, float Width, float Position, bool bNearestGap, float& OutOffset)
+{
+	const int32 Num = Openings.Num();
+	const float Desired = FMath::TruncToFloat(Position - Width / 2.0f);
+
+	// Gap index k lies between opening k - 1 and opening k
+	auto tryGap = [&](int32 Gap, float& OutSlot)
+	{
+		const float Start = (Gap > 0 ? Openings.GetEnd(Gap - 1) : 0.0f) + Aligment;
+		const float End	  = (Gap < Num ? Openings.Offsets[Gap] : WallLength) - Aligment - Width;
+
+		if (End < Start)
+			return false;
+
+		OutSlot = FMath::Clamp(Desired, Start, End);
+		return true;
+	};
+
+	const int32 Gap = FindOpeningAfter(Openings, Position);
+	const bool bInsideOpening = Gap > 0 && Openings.GetEnd(Gap - 1) > Position;
+
+	if (!bInsideOpening && tryGap(Gap, OutOffset))
+		return true;
+
+	if (!bNearestGap)
+		return false;
+
+	// First gap with enough space on each side is the closest one on that side, narrow gaps are walked over one by one
+	float LeftSlot	= 0.0f;
+	float RightSlot = 0.0f;
+	bool bLeft	= false;
+	bool bRight = false;
+
+	for (int32 k = Gap - 1; k >= 0 && !bLeft; --k)
+		bLeft = tryGap(k, LeftSlot);
+
+	for (int32 k = bInsideOpening ? Gap : Gap + 1; k <= Num && !bRight; ++k)
+		bRight = tryGap(k, RightSlot);
+
+	if (bLeft && (!bRight || Desired - LeftSlot <= RightSlot - Desired))
+		OutOffset = LeftSlot;
+	else if (bRight)
+		OutOffset = RightSlot;
+
+	return bLeft || bRight;
+}
+
+float RoomLayout::ClampOpeningOffset(const FWallOpenings& Openings, float WallLength, float Aligment, int32 Index, float Offset)
+{
+	// Opening can not pass its neighbours, so order of openings never changes
+	const float Min = (Index > 0 ? Openings.GetEnd(Index - 1) : 0.0f) + Aligment;
+	const float Max = (Index < Openings.Num() - 1 ? Openings.Offsets[Index + 1] : WallLength) - Aligment - Openings.Widths[Index];
+
+	return FMath::Clamp(Offset, Min, FMath::Max(Min, Max));
+}
+
+void RoomLayout::FitOpenings(const FWallOpenings& Openings, float WallLength, float Aligment, TArray<float>& OutOffsets, TArray<int32>& OutRemoved)
+{
+	const int32 Num = Openings.Num();
+
+	OutOffsets = Openings.Offsets;
+	OutRemoved.Reset();
+
+	// Push openings off the wall start, then back from the wall end
+	float MinOffset = Aligment;
+	for (int32 idx = 0; idx < Num; ++idx)
+	{
+		OutOffsets[idx] = FMath::Max(OutOffsets[idx], MinOffset);
+		MinOffset = OutOffsets[idx] + Openings.Widths[idx] + Aligment;
+	}
+
+	float MaxEnd = WallLength - Aligment;
+	for (int32 idx = Num - 1; idx >= 0; --idx)
+	{
+		OutOffsets[idx] = FMath::Min(OutOffsets[idx], MaxEnd - Openings.Widths[idx]);
+		MaxEnd = OutOffsets[idx] - Aligment;
+	}
+
+	// Openings pushed back over their left neighbour do not fit, the ones after them still keep their place
+	MinOffset = Aligment;
+	for (int32 idx = 0; idx < Num; ++idx)
+	{
+		if (OutOffsets[idx] < MinOffset)
+		{
+			OutOffsets[idx] = Openings.Offsets[idx];
+			OutRemoved.Add(idx);
+			continue;
+		}
+
+		MinOffset = OutOffsets[idx] + Openings.Widths[idx] + Aligment;
+	}
+}
+
+int32 RoomLayout::FillWall(const FWallOpenings& Openings, float WallLength, float Aligment, float Width, int32 Count, float Pitch, TArray<float>& OutOffsets)
+{
+	OutOffsets.Reset();
+
+	const int32 Num = Openings.Num();
+	if (Count <= 0 || Width <= 0.0f)
+		return 0;
+
+	// Gap k lies between opening k - 1 and opening k
+	auto gapStart = [&](int32 Gap) { return Gap > 0 ? Openings.GetEnd(Gap - 1) : 0.0f; };
+	auto gapEnd	  = [&](int32 Gap) { return Gap < Num ? Openings.Offsets[Gap] : WallLength; };
+
+	if (Pitch <= 0.0f)
+	{
+		// Space on each side of N openings spread evenly in gap
+		auto spacing = [&](int32 Gap, int32 N) { return (gapEnd(Gap) - gapStart(Gap) - N * Width) / (N + 1); };
+
+		TArray<int32> Counts;
+		Counts.SetNumZeroed(Num + 1);
+
+		// Gaps keyed by spacing with one more opening, widest first and later gap on ties
+		struct FGapSpacing
+		{
+			float Spacing;
+			int32 Gap;
+		};
+
+		auto wider = [](const FGapSpacing& A, const FGapSpacing& B)
+		{
+			return A.Spacing > B.Spacing || (A.Spacing == B.Spacing && A.Gap > B.Gap);
+		};
+
+		TArray<FGapSpacing> Heap;
+		Heap.Reserve(Num + 1);
+
+		for (int32 k = 0; k <= Num; ++k)
+		{
+			if (spacing(k, 1) >= Aligment)
+				Heap.Add({ spacing(k, 1), k });
+		}
+
+		Heap.Heapify(wider);
+
+		// Every opening goes to the gap which stays widest spaced with it, O(Num + Count log Num)
+		for (int32 Placed = 0; Placed < Count && Heap.Num() > 0; ++Placed)
+		{
+			FGapSpacing Best;
+			Heap.HeapPop(Best, wider, false);
+
+			const int32 Gap = Best.Gap;
+			Counts[Gap]++;
+
+			// Spacing only shrinks with more openings, full gap leaves the heap
+			const float Next = spacing(Gap, Counts[Gap] + 1);
+			if (Next >= Aligment)
+				Heap.HeapPush({ Next, Gap }, wider);
+		}
+
+		for (int32 k = 0; k <= Num; ++k)
+		{
+			if (Counts[k] == 0)
+				continue;
+
+			const float Spacing = spacing(k, Counts[k]);
+
+			for (int32 idx = 0; idx < Counts[k]; ++idx)
+				OutOffsets.Add(gapStart(k) + Spacing + idx * (Width + Spacing));
+		}
+
+		return OutOffsets.Num();
+	}
+
+	Pitch = FMath::Max(Pitch, Width + Aligment);
+
+	const float Min = Aligment;
+	const float Max = WallLength - Aligment - Width;
+	if (Max < Min)
+		return 0;
+
+	// Grid phase puts as many of Count openings as fit on free wall to its center
+	const int32 Run	  = FMath::Min(Count, FMath::FloorToInt((Max - Min) / Pitch) + 1);
+	const float First = (WallLength - (Run - 1) * Pitch - Width) / 2.0f;
+	const float Phase = First - FMath::FloorToFloat((First - Min) / Pitch) * Pitch;
+
+	// Free grid places in wall order, existing openings are walked once
+	TArray<float> Free;
+	int32 Next = 0;
+
+	for (int32 idx = 0; Phase + idx * Pitch <= Max; ++idx)
+	{
+		const float Offset = Phase + idx * Pitch;
+
+		while (Next < Num && Openings.GetEnd(Next) + Aligment <= Offset)
+			Next++;
+
+		if (Next == Num || Offset + Width + Aligment <= Openings.Offsets[Next])
+			Free.Add(Offset);
+	}
+
+	// Places closest to wall center form a run around it
+	const float Center = (WallLength - Width) / 2.0f;
+
+	int32 Hi = Algo::LowerBound(Free, Center);
+	int32 Lo = Hi - 1;
+
+	for (int32 Placed = 0; Placed < Count && (Lo >= 0 || Hi < Free.Num()); ++Placed)
+	{
+		if (Hi >= Free.Num() || (Lo >= 0 && Center - Free[Lo] <= Free[Hi] - Center))
+			Lo--;
+		else
+			Hi++;
+	}
+
+	OutOffsets.Append(Free.GetData() + Lo + 1, Hi - Lo - 1);
+
+	return OutOffsets.Num();
+}
+
+void RoomLayout::ClampDimensions(FRoomLayoutSettings& Settings, TArrayView<const FWallLayoutInput> Walls)
+{
+	// Fixed shapes keep minimal dimensions, polygon edges are checked by ValidateOutline
+	if (Settings.Shape == ELayoutRoomShape::Standard)
+	{
+		Settings.Length = FMath::Max(Settings.Length, Settings.MinimalWallLength);
+		Settings.Width	= FMath::Max(Settings.Width, Settings.MinimalWallLength);
+	}
+	else if (Settings.Shape == ELayoutRoomShape::LShape)
+	{
+		Settings.Length = FMath::Max(Settings.Length, Settings.MinimalWallLength * 2);
+		Settings.Width	= FMath::Max(Settings.Width, Settings.MinimalWallLength * 2);
+	}
+
+	FRoomOutline Outline;
+	TArray<FWallPlacement> Placements;
+
+	// Stretching one wall also lengthens walls parallel to it, so placements are taken again after each stretch.
+	// Stretched wall stays long enough, so there are at most as many passes as walls.
+	for (int32 Pass = 0; Pass < Walls.Num(); ++Pass)
+	{
+		ComputeWallPlacements(Settings, Placements);
+
+		int32 ShortWall = INDEX_NONE;
+		float Missing = 0.0f;
+
+		for (int32 idx = 0; idx < FMath::Min(Walls.Num(), Placements.Num()); ++idx)
+		{
+			Missing = GetRequiredLength(Walls[idx], Settings.AligmentOffset) - Placements[idx].Length;
+
+			if (Missing > KINDA_SMALL_NUMBER)
+			{
+				ShortWall = idx;
+				break;
+			}
+		}
+
+		if (ShortWall == INDEX_NONE)
+			return;
+
+		BuildOutline(Settings, Outline);
+
+		const int32 Edge = Outline.WallIndices.Find(ShortWall);
+		const FVector2D& A = Outline.Points[Edge];
+		const FVector2D& B = Outline.Points[(Edge + 1) % Outline.Points.Num()];
+
+		// Openings are placed from wall start, so everything at or past the wall end moves away from it
+		const int32 Axis = IsAlongX(A, B) ? 0 : 1;
+		const float Cut	 = FMath::Max(A[Axis], B[Axis]) - KINDA_SMALL_NUMBER;
+		const float Grow = FMath::CeilToFloat(Missing);
+
+		for (FVector2D& Point : Outline.Points)
+		{
+			if (Point[Axis] >= Cut)
+				Point[Axis] += Grow;
+		}
+
+		// Fixed shapes read their dimensions back in BuildOutline point order
+		if (Settings.Shape == ELayoutRoomShape::Standard)
+		{
+			Settings.Length = Outline.Points[1].X;
+			Settings.Width	= Outline.Points[2].Y;
+		}
+		else if (Settings.Shape == ELayoutRoomShape::LShape)
+		{
+			Settings.Length	 = Outline.Points[1].X;
+			Settings.CornerY = Outline.Points[2].Y;
+			Settings.CornerX = Outline.Points[3].X;
+			Settings.Width	 = Outline.Points[4].Y;
+		}
+		else
+		{
+			Settings.Outline = Outline.Points;
+		}
+	}
+}
+
+FVector2D RoomLayout::ClampCorner(const FRoomLayoutSettings& Settings, FVector2D Corner)
+{
+	return FVector2D(
+		FMath::Clamp(Corner.X, Settings.MinimalWallLength, Settings.Length - Settings.MinimalWallLength),
+		FMath::Clamp(Corner.Y, Settings.MinimalWallLength, Settings.Width - Settings.MinimalWallLength));
+}
+
+void RoomLayout::ComputeSurfaces(const FRoomLayoutSettings& Settings, FSurfaceLayout& OutSurfaces)
+{
+	OutSurfaces.Corners.Reset();
+
+	FRoomOutline Outline;
+	BuildOutline(Settings, Outline);
+
+	OutSurfaces.Outline = MoveTemp(Outline.Points);
+
+	const TArray<FVector2D>& Points = OutSurfaces.Outline;
+	const int32 Num = Points.Num();
+	const float Height	   = Settings.Height;
+	const float WallOffset = Settings.WallOffset;
+
+	// Square between wall ends at every point, outside of the outline or inside an inner corner
+	const float Winding = GetWinding(Points);
+	const FVector CornerScale(1.0f, WallOffset, Height);
+
+	for (int32 idx = 0; idx < Num; ++idx)
+	{
+		const FVector2D& Point = Points[idx];
+		const FVector2D Diagonal = GetOutwardNormal(Points[(idx + Num - 1) % Num], Point, Winding) + GetOutwardNormal(Point, Points[(idx + 1) % Num], Winding);
+
+		const FVector2D Min = Point + FVector2D(FMath::Min(Diagonal.X, 0.0f), FMath::Min(Diagonal.Y, 0.0f)) * WallOffset;
+		OutSurfaces.Corners.Add(MakeSegment(FVector(Min, 0.0f), CornerScale));
+	}
+}
+
+bool RoomLayout::TriangulateOutline(TArrayView<const FVector2D> Points, TArray<int32>& OutTriangles)
+{
+	OutTriangles.Reset();
+
+	const int32 Num = Points.Num();
+	if (Num < 3)
+		return false;
+
+	OutTriangles.Reserve((Num - 2) * 3);
+
+	// Clip ears in counterclockwise order
+	const bool bReverse = GetWinding(Points) < 0.0f;
+
+	TArray<int32> Remaining;
+	Remaining.SetNumUninitialized(Num);
+
+	for (int32 idx = 0; idx < Num; ++idx)
+		Remaining[idx] = bReverse ? Num - 1 - idx : idx;
+
+	int32 Current = 0;
+	int32 Checked = 0;
+
+	while (Remaining.Num() > 3)
+	{
+		// Every point was checked since last clip, outline is not simple
+		if (Checked >= Remaining.Num())
+		{
+			OutTriangles.Reset();
+			return false;
+		}
+
+		const int32 Count = Remaining.Num();
+		Current %= Count;
+
+		const int32 Prev = Remaining[(Current + Count - 1) % Count];
+		const int32 Curr = Remaining[Current];
+		const int32 Next = Remaining[(Current + 1) % Count];
+
+		const FVector2D& A = Points[Prev];
+		const FVector2D& B = Points[Curr];
+		const FVector2D& C = Points[Next];
+
+		// Reflex and collinear points are not ears
+		bool bEar = ((B - A) ^ (C - B)) > 0.0f;
+
+		// No other point inside the ear or on its new edge
+		for (int32 idx = 0; idx < Count && bEar; ++idx)
+		{
+			const int32 Other = Remaining[idx];
+			if (Other == Prev || Other == Curr || Other == Next)
+				continue;
+
+			const FVector2D& P = Points[Other];
+			bEar = !(((B - A) ^ (P - A)) > 0.0f && ((C - B) ^ (P - B)) > 0.0f && ((A - C) ^ (P - C)) >= 0.0f);
+		}
+
+		if (!bEar)
+		{
+			Current++;
+			Checked++;
+			continue;
+		}
+
+		OutTriangles.Add(Prev);
+		OutTriangles.Add(Curr);
+		OutTriangles.Add(Next);
+
+		Remaining.RemoveAt(Current, 1, false);
+		Checked = 0;
+	}
+
+	OutTriangles.Append(Remaining);
+	return true;
+}
+
+bool RoomLayout::BuildSurfaceMesh(TArrayView<const FVector2D> Outline, bool bFaceUp, float UVSize, FWallMeshData& OutMesh)
+{
+	OutMesh.Vertices.Reset(Outline.Num());
+	OutMesh.Normals.Reset(Outline.Num());
+	OutMesh.UVs.Reset(Outline.Num());
+
+	if (!TriangulateOutline(Outline, OutMesh.Triangles))
+		return false;
+
+	UVSize = FMath::Max(UVSize, 1.0f);
+
+	const FVector Normal(0.0f, 0.0f, bFaceUp ? 1.0f : -1.0f);
+
+	for (const auto& Point : Outline)
+	{
+		OutMesh.Vertices.Add(FVector(Point, 0.0f));
+		OutMesh.Normals.Add(Normal);
+		OutMesh.UVs.Add(Point / UVSize);
+	}
+
+	// Front faces wind against normal like wall quads, so floor triangles are reversed
+	if (bFaceUp)
+	{
+		for (int32 idx = 0; idx < OutMesh.Triangles.Num(); idx += 3)
+			Swap(OutMesh.Triangles[idx + 1], OutMesh.Triangles[idx + 2]);
+	}
+
+	return true;
+}
+
+void RoomLayout::SolveRoom(const FRoomLayoutInput& Input, FRoomLayoutResult& OutResult)
+{
+	FRoomLayoutSettings& Settings = OutResult.Settings;
+	Settings = Input.Settings;
+
+	ClampDimensions(Settings, Input.Walls);
+
+	const FVector2D Corner = ClampCorner(Settings, FVector2D(Settings.CornerX, Settings.CornerY));
+	Settings.CornerX = Corner.X;
+	Settings.CornerY = Corner.Y;
+
+	ComputeSurfaces(Settings, OutResult.Surfaces);
+
+	ComputeWallPlacements(Settings, OutResult.Placements);
+
+	const int32 NumWalls = FMath::Min(Input.Walls.Num(), OutResult.Placements.Num());
+	OutResult.Placements.SetNum(NumWalls);
+	OutResult.Walls.SetNum(NumWalls);
+
+	for (int32 idx = 0; idx < NumWalls; ++idx)
+	{
+		SolveWall(Settings, OutResult.Placements[idx], Input.Walls[idx].Openings, OutResult.Walls[idx]);
+	}
+}
+
+void RoomLayout::GenerateRandomRoom(FRandomStream& Stream, int32 MaxOpeningsPerWall, FRoomLayoutInput& OutInput)
+{
+	FRoomLayoutSettings& Settings = OutInput.Settings;
+	Settings = FRoomLayoutSettings();
+
+	const float ShapeRoll = Stream.FRandRange(0.0f, 1.0f);
+
+	Settings.Shape	= ShapeRoll < 0.4f ? ELayoutRoomShape::Standard : (ShapeRoll < 0.8f ? ELayoutRoomShape::LShape : ELayoutRoomShape::Polygon);
+	Settings.Length = Stream.FRandRange(440.0f, 1000.0f);
+	Settings.Width	= Stream.FRandRange(440.0f, 1000.0f);
+	Settings.Height = Stream.FRandRange(270.0f, 350.0f);
+
+	const FVector2D Corner = ClampCorner(Settings, FVector2D(Stream.FRandRange(0.0f, Settings.Length), Stream.FRandRange(0.0f, Settings.Width)));
+	Settings.CornerX = Corner.X;
+	Settings.CornerY = Corner.Y;
+
+	// Polygon rooms are U shaped with a notch cut into the north side
+	if (Settings.Shape == ELayoutRoomShape::Polygon)
+	{
+		const float Length	 = Settings.Length;
+		const float Width	 = Settings.Width;
+		const float NotchX	 = FMath::RoundToFloat(Length * Stream.FRandRange(0.4f, 0.6f));
+		const float NotchY0	 = FMath::RoundToFloat(Width * Stream.FRandRange(0.25f, 0.4f));
+		const float NotchY1	 = FMath::RoundToFloat(Width * Stream.FRandRange(0.6f, 0.75f));
+
+		Settings.Outline = { FVector2D(0.0f, 0.0f), FVector2D(Length, 0.0f), FVector2D(Length, NotchY0), FVector2D(NotchX, NotchY0),
+			FVector2D(NotchX, NotchY1), FVector2D(Length, NotchY1), FVector2D(Length, Width), FVector2D(0.0f, Width) };
+	}
+
+	TArray<FWallPlacement> Placements;
+	ComputeWallPlacements(Settings, Placements);
+
+	const int32 NumWalls = Placements.Num();
+	OutInput.Walls.SetNum(NumWalls);
+
+	for (int32 idx = 0; idx < NumWalls; ++idx)
+	{
+		auto& Openings = OutInput.Walls[idx].Openings;
+		Openings.Reset();
+
+		const float WallLength = Placements[idx].Length;
+
+		// Place openings from left to right with random gaps
+		float Cursor = 0.0f;
+		for (int32 Count = 0; Count < MaxOpeningsPerWall; ++Count)
+		{
+			FLayoutOpening Opening;
+			Opening.Type   = Stream.FRandRange(0.0f, 1.0f) < 0.3f ? ELayoutOpeningType::Door : ELayoutOpeningType::Window;
+			Opening.Width  = Opening.Type == ELayoutOpeningType::Door ? 90.0f : Stream.FRandRange(60.0f, 150.0f);
+			Opening.Height = Opening.Type == ELayoutOpeningType::Door ? 210.0f : 140.0f;
+			Opening.Offset = Cursor + Settings.AligmentOffset + Stream.FRandRange(0.0f, 150.0f);
+
+			if (Opening.Offset + Opening.Width + Settings.AligmentOffset > WallLength)
+				break;
+
+			Openings.Add(Opening);
+			Cursor = Opening.Offset + Opening.Width;
+		}
+	}
+}
@@ -0,0 +1,1304 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RoomLayoutBenchmarkCommandlet.h"
+#include "RoomLayout.h"
+#include "Room.h"
+#include "FloorPlan.h"
+#include "RoomDescription.h"
+#include "RoomLayoutSubsystem.h"
+#include "Misc/Parse.h"
+#include "Algo/Reverse.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "ProceduralMeshComponent.h"
+#include "GameFramework/WorldSettings.h"
+
+namespace
+{
+	// Return percentile of sorted samples in microseconds
+	double GetPercentileUs(const TArray<uint64>& SortedCycles, double Percentile)
+	{
+		if (SortedCycles.Num() == 0)
+			return 0.0;
+
+		const int32 Index = FMath::Clamp((int32)(Percentile * (SortedCycles.Num() - 1)), 0, SortedCycles.Num() - 1);
+		return FPlatformTime::ToMilliseconds64(SortedCycles[Index]) * 1000.0;
+	}
+
+	// Floor and ceiling must cover the outline in either winding, each triangle facing against its normal
+	bool ValidateSurfaceMesh(TArrayView<const FVector2D> Outline, FString& OutError)
+	{
+		float Area = 0.0f;
+		for (int32 idx = 0; idx < Outline.Num(); ++idx)
+			Area += Outline[idx] ^ Outline[(idx + 1) % Outline.Num()];
+
+		Area = FMath::Abs(Area) / 2.0f;
+
+		for (bool bFaceUp : { true, false })
+		{
+			FWallMeshData Mesh;
+			if (!RoomLayout::BuildSurfaceMesh(Outline, bFaceUp, 100.0f, Mesh) || Mesh.Triangles.Num() != (Outline.Num() - 2) * 3)
+			{
+				OutError = FString::Printf(TEXT("outline of %d points is not triangulated"), Outline.Num());
+				return false;
+			}
+
+			float Covered = 0.0f;
+			for (int32 idx = 0; idx < Mesh.Triangles.Num(); idx += 3)
+			{
+				const FVector& A = Mesh.Vertices[Mesh.Triangles[idx]];
+				const FVector& B = Mesh.Vertices[Mesh.Triangles[idx + 1]];
+				const FVector& C = Mesh.Vertices[Mesh.Triangles[idx + 2]];
+
+				// Twice the triangle area, negative when wound against the normal
+				const float Facing = ((B - A) ^ (C - A)).Z * Mesh.Normals[Mesh.Triangles[idx]].Z;
+				if (Facing > 0.0f)
+				{
+					OutError = FString::Printf(TEXT("%s triangle %d faces along its normal"), bFaceUp ? TEXT("floor") : TEXT("ceiling"), idx / 3);
+					return false;
+				}
+
+				Covered -= Facing / 2.0f;
+			}
+
+			if (!FMath::IsNearlyEqual(Covered, Area, Area * 1e-4f))
+			{
+				OutError = FString::Printf(TEXT("%s covers %.1f of outline area %.1f"), bFaceUp ? TEXT("floor") : TEXT("ceiling"), Covered, Area);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Filled openings must keep Aligment from wall ends, existing openings and each other
+	bool ValidateFill(const FWallOpenings& Openings, float WallLength, float Aligment, float Width, int32 Count, const TArray<float>& Offsets, FString& OutError)
+	{
+		if (Offsets.Num() > Count)
+		{
+			OutError = FString::Printf(TEXT("%d openings filled, %d requested"), Offsets.Num(), Count);
+			return false;
+		}
+
+		TArray<FVector2D> Spans;
+		for (int32 idx = 0; idx < Openings.Num(); ++idx)
+			Spans.Add(FVector2D(Openings.Offsets[idx], Openings.GetEnd(idx)));
+
+		for (float Offset : Offsets)
+			Spans.Add(FVector2D(Offset, Offset + Width));
+
+		Spans.Sort([](const FVector2D& A, const FVector2D& B) { return A.X < B.X; });
+
+		// Tolerance covers float sums of spacing
+		const float Tolerance = 0.01f;
+		float End = 0.0f;
+
+		for (const auto& Span : Spans)
+		{
+			if (Span.X - End < Aligment - Tolerance)
+			{
+				OutError = FString::Printf(TEXT("opening at %.2f is %.2f from previous end, aligment %.2f"), Span.X, Span.X - End, Aligment);
+				return false;
+			}
+
+			End = Span.Y;
+		}
+
+		if (WallLength - End < Aligment - Tolerance)
+		{
+			OutError = FString::Printf(TEXT("last opening ends %.2f before wall end, aligment %.2f"), WallLength - End, Aligment);
+			return false;
+		}
+
+		return true;
+	}
+
+	// Wall modes in order suites run them, names are values of -walls=
+	const TCHAR* WallModeNames[] = { TEXT("segments"), TEXT("instanced"), TEXT("procedural") };
+
+	ESuiteWallMode ParseWallMode(const FString& Params)
+	{
+		FString Name;
+		FParse::Value(*Params, TEXT("walls="), Name);
+
+		for (int32 idx = 0; idx < UE_ARRAY_COUNT(WallModeNames); ++idx)
+		{
+			if (Name == WallModeNames[idx])
+				return static_cast<ESuiteWallMode>(idx);
+		}
+
+		return ESuiteWallMode::Segments;
+	}
+
+	// Procedural mesh section must have vertices and indices of mesh built for the same layout
+	bool ValidateMeshSection(UProceduralMeshComponent* Component, int32 Section, const FWallMeshData& Mesh, FString& OutError)
+	{
+		auto section = IsValid(Component) ? Component->GetProcMeshSection(Section) : nullptr;
+		if (!section)
+		{
+			OutError = FString::Printf(TEXT("mesh section %d was not created"), Section);
+			return false;
+		}
+
+		if (section->ProcVertexBuffer.Num() != Mesh.Vertices.Num() || section->ProcIndexBuffer.Num() != Mesh.Triangles.Num())
+		{
+			OutError = FString::Printf(TEXT("mesh section %d has %d vertices and %d indices, layout builds %d and %d"), Section,
+				section->ProcVertexBuffer.Num(), section->ProcIndexBuffer.Num(), Mesh.Vertices.Num(), Mesh.Triangles.Num());
+			return false;
+		}
+
+		for (int32 idx = 0; idx < Mesh.Vertices.Num(); ++idx)
+		{
+			if (!section->ProcVertexBuffer[idx].Position.Equals(Mesh.Vertices[idx], 0.01f))
+			{
+				OutError = FString::Printf(TEXT("vertex %d of mesh section %d is not at its built position"), idx, Section);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// U shaped outline with random notch on the north side
+	TArray<FVector2D> MakeRandomOutline(FRandomStream& Stream)
+	{
+		const float Length	= Stream.FRandRange(440.0f, 1000.0f);
+		const float Width	= Stream.FRandRange(600.0f, 1000.0f);
+		const float NotchX	= FMath::RoundToFloat(Length * Stream.FRandRange(0.4f, 0.6f));
+		const float NotchY0 = FMath::RoundToFloat(Width * Stream.FRandRange(0.25f, 0.4f));
+		const float NotchY1 = FMath::RoundToFloat(Width * Stream.FRandRange(0.6f, 0.75f));
+
+		return TArray<FVector2D>({ FVector2D(0.0f, 0.0f), FVector2D(Length, 0.0f), FVector2D(Length, NotchY0), FVector2D(NotchX, NotchY0),
+			FVector2D(NotchX, NotchY1), FVector2D(Length, NotchY1), FVector2D(Length, Width), FVector2D(0.0f, Width) });
+	}
+}
+
+URoomLayoutBenchmarkCommandlet::URoomLayoutBenchmarkCommandlet()
+{
+	IsClient	 = false;
+	IsServer	 = false;
+	IsEditor	 = false;
+	LogToConsole = true;
+}
+
+int32 URoomLayoutBenchmarkCommandlet::Main(const FString& Params)
+{
+	bool bValid = RunLayoutBenchmark(Params);
+
+	// Room suites run in every wall mode unless -walls= picks one
+	TArray<FString> ModeParams;
+
+	FString Walls;
+	if (FParse::Value(*Params, TEXT("walls="), Walls))
+	{
+		ModeParams.Add(Params);
+	}
+	else
+	{
+		for (const TCHAR* Name : WallModeNames)
+			ModeParams.Add(Params + TEXT(" -walls=") + Name);
+	}
+
+	for (const auto& SuiteParams : ModeParams)
+	{
+		bValid = RunRoomSuite(SuiteParams) && bValid;
+		bValid = RunAsyncSuite(SuiteParams) && bValid;
+		bValid = RunUndoSuite(SuiteParams) && bValid;
+	}
+
+	bValid = RunFloorPlanSuite(Params) && bValid;
+
+	return bValid ? 0 : 1;
+}
+
+bool URoomLayoutBenchmarkCommandlet::RunLayoutBenchmark(const FString& Params)
+{
+	int32 NumRooms	  = 5000;
+	int32 MaxOpenings = 6;
+	int32 Seed		  = 1;
+
+	FParse::Value(*Params, TEXT("rooms="), NumRooms);
+	FParse::Value(*Params, TEXT("openings="), MaxOpenings);
+	FParse::Value(*Params, TEXT("seed="), Seed);
+
+	NumRooms = FMath::Max(NumRooms, 1);
+
+	// Generate rooms up front so only the solver is measured
+	FRandomStream Stream(Seed);
+
+	TArray<FRoomLayoutInput> Rooms;
+	Rooms.SetNum(NumRooms);
+
+	int32 NumWalls = 0;
+	for (auto& Room : Rooms)
+	{
+		RoomLayout::GenerateRandomRoom(Stream, MaxOpenings, Room);
+		NumWalls += Room.Walls.Num();
+	}
+
+	// Full room passes, equivalent of ARoom::UpdateAllWalls
+	FRoomLayoutResult Result;
+	int64 NumSegments = 0;
+
+	const uint64 RoomsStart = FPlatformTime::Cycles64();
+	for (const auto& Room : Rooms)
+	{
+		RoomLayout::SolveRoom(Room, Result);
+
+		for (const auto& Wall : Result.Walls)
+			NumSegments += Wall.HorizontalSegments.Num() + Wall.VerticalSegments.Num();
+	}
+	const double RoomsSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - RoomsStart);
+
+	// Single wall passes, equivalent of ARoom::UpdateWall
+	TArray<uint64> WallCycles;
+	WallCycles.Reserve(NumWalls);
+
+	FWallLayout WallLayout;
+	TArray<FWallPlacement> Placements;
+	for (const auto& Room : Rooms)
+	{
+		// Placements come from one pass per rebuild, as in ARoom::RebuildDirty
+		RoomLayout::ComputeWallPlacements(Room.Settings, Placements);
+
+		for (int32 idx = 0; idx < Room.Walls.Num(); ++idx)
+		{
+			const uint64 WallStart = FPlatformTime::Cycles64();
+
+			RoomLayout::SolveWall(Room.Settings, Placements[idx], Room.Walls[idx].Openings, WallLayout);
+
+			WallCycles.Add(FPlatformTime::Cycles64() - WallStart);
+			NumSegments += WallLayout.HorizontalSegments.Num();
+		}
+	}
+
+	WallCycles.Sort();
+
+	// Validation is kept out of timed loops
+	int32 NumInvalid = 0;
+	int32 NumInvalidSurfaces = 0;
+	int32 NumInvalidFills = 0;
+
+	FRandomStream FillStream(Seed);
+	TArray<float> Filled;
+
+	FRandomStream OutlineStream(Seed);
+	TArray<FVector2D> Outline;
+
+	for (const auto& Room : Rooms)
+	{
+		RoomLayout::SolveRoom(Room, Result);
+
+		for (int32 idx = 0; idx < Result.Walls.Num(); ++idx)
+		{
+			FString Error;
+			if (!RoomLayout::ValidateWallLayout(Result.Settings, Result.Placements[idx], Room.Walls[idx].Openings, Result.Walls[idx], Error) && NumInvalid++ == 0)
+				UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: invalid wall %d: %s"), idx, *Error);
+
+			// Fill every wall in both spacing modes, pitch may be below width plus aligment
+			const float WallLength = Result.Placements[idx].Length;
+			const float Aligment   = Result.Settings.AligmentOffset;
+			const float Width	   = FillStream.FRandRange(60.0f, 160.0f);
+			const int32 Count	   = FillStream.RandRange(1, 12);
+			const float Pitch	   = FillStream.FRandRange(0.0f, 400.0f);
+
+			for (float FillPitch : { 0.0f, Pitch })
+			{
+				RoomLayout::FillWall(Room.Walls[idx].Openings, WallLength, Aligment, Width, Count, FillPitch, Filled);
+
+				if (!ValidateFill(Room.Walls[idx].Openings, WallLength, Aligment, Width, Count, Filled, Error) && NumInvalidFills++ == 0)
+					UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: invalid fill of wall %d with pitch %.1f: %s"), idx, FillPitch, *Error);
+			}
+		}
+
+		// Room outline is counterclockwise, reversed and U shaped outlines cover clockwise and reflex corners
+		for (int32 pass = 0; pass < 3; ++pass)
+		{
+			if (pass == 0)
+				Outline = Result.Surfaces.Outline;
+			else if (pass == 1)
+				Algo::Reverse(Outline);
+			else
+				Outline = MakeRandomOutline(OutlineStream);
+
+			FString Error;
+			if (!ValidateSurfaceMesh(Outline, Error) && NumInvalidSurfaces++ == 0)
+				UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: invalid surface: %s"), *Error);
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("RoomLayoutBenchmark: %d rooms, %d walls, seed %d (checksum %lld)"), NumRooms, NumWalls, Seed, NumSegments);
+	UE_LOG(LogTemp, Display, TEXT("RoomLayoutBenchmark: %.0f rooms/s (%.3f ms total)"), NumRooms / FMath::Max(RoomsSeconds, 1e-9), RoomsSeconds * 1000.0);
+	UE_LOG(LogTemp, Display, TEXT("RoomLayoutBenchmark: UpdateWall p50 %.3f us, p99 %.3f us, max %.3f us"),
+		GetPercentileUs(WallCycles, 0.5), GetPercentileUs(WallCycles, 0.99), GetPercentileUs(WallCycles, 1.0));
+
+	if (NumInvalid > 0)
+		UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: %d invalid walls"), NumInvalid);
+
+	if (NumInvalidSurfaces > 0)
+		UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: %d invalid floor or ceiling meshes"), NumInvalidSurfaces);
+
+	if (NumInvalidFills > 0)
+		UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: %d invalid wall fills"), NumInvalidFills);
+
+	return NumInvalid == 0 && NumInvalidSurfaces == 0 && NumInvalidFills == 0;
+}
+
+bool URoomLayoutBenchmarkCommandlet::BeginSuiteWorld(const TCHAR* Name)
+{
+	WallMesh	= LoadObject<UStaticMesh>(nullptr, TEXT("/Game/Meshes/Default_meshes/Geometries/Wall.Wall"));
+	FloorMesh	= LoadObject<UStaticMesh>(nullptr, TEXT("/Game/Meshes/Default_meshes/Geometries/Floor.Floor"));
+	CeilingMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Game/Meshes/Default_meshes/Geometries/Ceiling.Ceiling"));
+	DoorMesh	= LoadObject<UStaticMesh>(nullptr, TEXT("/Game/Meshes/Default_meshes/Geometries/Door.Door"));
+	WindowMesh	= LoadObject<UStaticMesh>(nullptr, TEXT("/Game/Meshes/Default_meshes/Geometries/Window.Window"));
+
+	if (!WallMesh || !FloorMesh || !CeilingMesh || !DoorMesh || !WindowMesh)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: default meshes not found."));
+		return false;
+	}
+
+	// Transient game world without rendering
+	SuiteWorld = UWorld::CreateWorld(EWorldType::Game, false, Name);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(SuiteWorld);
+
+	SuiteWorld->InitializeActorsForPlay(FURL());
+	SuiteWorld->BeginPlay();
+
+	// World has no game mode to start play, rooms spawned after this begin play in FinishSpawning
+	SuiteWorld->GetWorldSettings()->NotifyBeginPlay();
+
+	ConstructedRooms.Reset();
+	ConstructedFailure.Reset();
+
+	return true;
+}
+
+void URoomLayoutBenchmarkCommandlet::EndSuiteWorld()
+{
+	if (!SuiteWorld)
+		return;
+
+	SuiteWorld->DestroyWorld(false);
+	GEngine->DestroyWorldContext(SuiteWorld);
+
+	SuiteWorld = nullptr;
+	ConstructedRooms.Reset();
+}
+
+ARoom* URoomLayoutBenchmarkCommandlet::SpawnRoom(RoomType Type)
+{
+	// Room is created in BeginPlay, so it is returned before FinishSpawning
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.bDeferConstruction = true;
+
+	ARoom* Room = SuiteWorld->SpawnActor<ARoom>(ARoom::StaticClass(), FTransform::Identity, SpawnParams);
+
+	Room->Type			= Type;
+	Room->WallMesh		= WallMesh;
+	Room->FloorMesh		= FloorMesh;
+	Room->CeilingMesh	= CeilingMesh;
+	Room->DoorMeshes	= { DoorMesh };
+	Room->WindowMeshes	= { WindowMesh };
+
+	Room->bUseInstancedSegments = WallMode == ESuiteWallMode::Instanced;
+	Room->bUseProceduralWalls	= WallMode == ESuiteWallMode::Procedural;
+
+	// Native room has no root, blueprint adds one
+	auto Root = NewObject<USceneComponent>(Room, TEXT("Root"));
+	Room->SetRootComponent(Root);
+	Root->RegisterComponent();
+
+	return Room;
+}
+
+void URoomLayoutBenchmarkCommandlet::ApplyRandomEdit(ARoom* Room, FRandomStream& Stream)
+{
+	if (Room->Walls.Num() == 0)
+		return;
+
+	auto wall = Room->Walls[Stream.RandRange(0, Room->Walls.Num() - 1)];
+	auto obj  = wall->Objects.Num() > 0 ? wall->Objects[Stream.RandRange(0, wall->Objects.Num() - 1)] : nullptr;
+
+	const int32 Kind = Stream.RandRange(0, 11);
+	const float Position = Stream.FRandRange(0.0f, wall->Length);
+	const float Dimension = Stream.FRandRange(440.0f, 1000.0f);
+	const FVector2D Corner(Stream.FRandRange(0.0f, Room->Length), Stream.FRandRange(0.0f, Room->Width));
+
+	if (Kind < 4)
+		Room->AddObjectToWall(wall, Position, Kind % 2 == 0 ? ObjectType::DOOR : ObjectType::WINDOW, 0);
+	else if (Kind < 7 && obj)
+		Room->MoveObject(obj, Position);
+	else if (Kind < 9 && obj)
+		Room->RemoveObjectFromWall(obj);
+	else if (Kind == 9 && Room->Type == RoomType::POLYGON)
+		Room->SetOutline(MakeRandomOutline(Stream));
+	else if (Kind == 9 && Stream.RandRange(0, 1) == 0)
+		Room->SetLength(Dimension);
+	else if (Kind == 9)
+		Room->SetWidth(Dimension);
+	else if (Kind == 10)
+		Room->SetHeight(Stream.FRandRange(250.0f, 400.0f));
+	else if (Kind == 11 && Room->Type == RoomType::L_SHAPE)
+		Room->SetCorner(Corner);
+}
+
+void URoomLayoutBenchmarkCommandlet::HandleRoomConstructed(ARoom* Room)
+{
+	ConstructedRooms.Add(Room);
+
+	// Room must be complete the moment it reports construction
+	FString Error;
+	if (ConstructedFailure.IsEmpty() && !ValidateRoom(Room, Error))
+		ConstructedFailure = FString::Printf(TEXT("%s reported construction before layout was applied: %s"), *Room->GetName(), *Error);
+}
+
+bool URoomLayoutBenchmarkCommandlet::RunRoomSuite(const FString& Params)
+{
+	int32 NumActors		   = 20;
+	int32 NumOps		   = 200;
+	int32 Seed			   = 1;
+	float BudgetUs		   = 5000.0f;
+	int32 BudgetComponents = 4;
+
+	FParse::Value(*Params, TEXT("actors="), NumActors);
+	FParse::Value(*Params, TEXT("ops="), NumOps);
+	FParse::Value(*Params, TEXT("seed="), Seed);
+	FParse::Value(*Params, TEXT("budgetus="), BudgetUs);
+	FParse::Value(*Params, TEXT("budgetcomponents="), BudgetComponents);
+
+	if (NumActors <= 0)
+		return true;
+
+	WallMode = ParseWallMode(Params);
+
+	if (!BeginSuiteWorld(TEXT("RoomLayoutBenchmark")))
+		return false;
+
+	FRandomStream Stream(Seed);
+
+	TArray<uint64> OpCycles;
+	OpCycles.Reserve(NumActors * NumOps);
+
+	int32 MaxNewComponents = 0;
+	FString Failure;
+
+	TArray<uint64> LoadCycles;
+	LoadCycles.Reserve(NumActors);
+
+	const RoomType Types[] = { RoomType::STANDARD, RoomType::L_SHAPE, RoomType::POLYGON };
+
+	for (int32 r = 0; r < NumActors && Failure.IsEmpty(); ++r)
+	{
+		ARoom* Room = SpawnRoom(Types[r % UE_ARRAY_COUNT(Types)]);
+		if (Room->Type == RoomType::POLYGON)
+			Room->Outline = MakeRandomOutline(Stream);
+
+		Room->FinishSpawning(FTransform::Identity);
+
+		if (!Room->HasActorBegunPlay() || Room->Walls.Num() == 0)
+			Failure = FString::Printf(TEXT("room %d was not created"), r);
+		else if (!ValidateRoom(Room, Failure))
+			Failure = FString::Printf(TEXT("room %d after CreateRoom: %s"), r, *Failure);
+
+		Room->StartEditLog();
+
+		for (int32 op = 0; op < NumOps && Failure.IsEmpty(); ++op)
+		{
+			const int32 ComponentsBefore = Room->GetComponents().Num();
+			const uint64 OpStart = FPlatformTime::Cycles64();
+
+			ApplyRandomEdit(Room, Stream);
+
+			OpCycles.Add(FPlatformTime::Cycles64() - OpStart);
+
+			const int32 NewComponents = Room->GetComponents().Num() - ComponentsBefore;
+			MaxNewComponents = FMath::Max(MaxNewComponents, NewComponents);
+
+			if (NewComponents > BudgetComponents)
+				Failure = FString::Printf(TEXT("room %d op %d added %d components, budget %d"), r, op, NewComponents, BudgetComponents);
+			else if (!ValidateRoom(Room, Failure))
+				Failure = FString::Printf(TEXT("room %d op %d: %s"), r, op, *Failure);
+		}
+
+		// Simplified levels must show the edited room, full detail must come back after them
+		for (int32 Level : { 1, 2, 0 })
+		{
+			if (!Failure.IsEmpty())
+				break;
+
+			Room->SetLODLevel(Level);
+
+			if (!ValidateRoom(Room, Failure))
+				Failure = FString::Printf(TEXT("room %d at LOD %d: %s"), r, Level, *Failure);
+		}
+
+		// Saved room must load into identical room in one build
+		if (Failure.IsEmpty())
+		{
+			TArray<uint8> Saved;
+			Room->SaveToBytes(Saved);
+
+			const uint64 LoadStart = FPlatformTime::Cycles64();
+
+			ARoom* Loaded = SpawnRoom(RoomType::STANDARD);
+			const bool bLoaded = Loaded->LoadFromBytes(Saved);
+			Loaded->FinishSpawning(FTransform::Identity);
+
+			LoadCycles.Add(FPlatformTime::Cycles64() - LoadStart);
+
+			TArray<uint8> Resaved;
+			Loaded->SaveToBytes(Resaved);
+
+			if (!bLoaded)
+				Failure = FString::Printf(TEXT("room %d: saved data was not loaded"), r);
+			else if (!ValidateRoom(Loaded, Failure))
+				Failure = FString::Printf(TEXT("room %d after load: %s"), r, *Failure);
+			else if (Resaved != Saved)
+				Failure = FString::Printf(TEXT("room %d: loaded room differs from saved one"), r);
+
+			Loaded->Destroy();
+		}
+
+		// Recorded edits replayed on the initial room must end in the same room
+		if (Failure.IsEmpty())
+		{
+			TArray<uint8> Saved;
+			Room->SaveToBytes(Saved);
+
+			TArray<uint8> LogData;
+			Room->SaveEditLog(LogData);
+
+			FRoomEditLog Log;
+			const bool bLoaded = RoomDescription::Load(LogData, Log);
+
+			ARoom* Replayed = SpawnRoom(RoomType::STANDARD);
+			if (bLoaded)
+				Replayed->BuildFromDescription(Log.Initial);
+
+			Replayed->FinishSpawning(FTransform::Identity);
+
+			for (const auto& Edit : Log.Edits)
+				Replayed->ReplayEdit(Edit);
+
+			TArray<uint8> Resaved;
+			Replayed->SaveToBytes(Resaved);
+
+			if (!bLoaded)
+				Failure = FString::Printf(TEXT("room %d: saved edit log was not loaded"), r);
+			else if (Resaved != Saved)
+				Failure = FString::Printf(TEXT("room %d: replayed edit log differs from edited room"), r);
+
+			Replayed->Destroy();
+		}
+
+		Room->Destroy();
+	}
+
+	EndSuiteWorld();
+
+	OpCycles.Sort();
+
+	const double P99Us = GetPercentileUs(OpCycles, 0.99);
+
+	UE_LOG(LogTemp, Display, TEXT("RoomLayoutBenchmark: %d room actors with %s walls, %d edits, edit p50 %.3f us, p99 %.3f us, max %.3f us, max %d new components"),
+		NumActors, WallModeNames[static_cast<int32>(WallMode)], OpCycles.Num(), GetPercentileUs(OpCycles, 0.5), P99Us, GetPercentileUs(OpCycles, 1.0), MaxNewComponents);
+
+	LoadCycles.Sort();
+
+	UE_LOG(LogTemp, Display, TEXT("RoomLayoutBenchmark: %d rooms loaded, spawn and load p50 %.3f us, max %.3f us"),
+		LoadCycles.Num(), GetPercentileUs(LoadCycles, 0.5), GetPercentileUs(LoadCycles, 1.0));
+
+	if (Failure.IsEmpty() && P99Us > BudgetUs)
+		Failure = FString::Printf(TEXT("edit p99 %.3f us exceeds budget %.3f us"), P99Us, BudgetUs);
+
+	if (!Failure.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: %s"), *Failure);
+		return false;
+	}
+
+	return true;
+}
+
+bool URoomLayoutBenchmarkCommandlet::RunAsyncSuite(const FString& Params)
+{
+	int32 NumActors = 20;
+	int32 NumOps	= 200;
+	int32 Seed		= 1;
+
+	FParse::Value(*Params, TEXT("actors="), NumActors);
+	FParse::Value(*Params, TEXT("ops="), NumOps);
+	FParse::Value(*Params, TEXT("seed="), Seed);
+
+	if (NumActors <= 0)
+		return true;
+
+	WallMode = ParseWallMode(Params);
+
+	if (!BeginSuiteWorld(TEXT("RoomLayoutAsyncSuite")))
+		return false;
+
+	auto Subsystem = SuiteWorld->GetSubsystem<URoomLayoutSubsystem>();
+	if (!Subsystem)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: world has no layout subsystem."));
+		EndSuiteWorld();
+		return false;
+	}
+
+	FRandomStream Stream(Seed);
+	FString Failure;
+
+	// Every other room creates its components over frames, all rooms are laid out in background
+	const RoomType Types[] = { RoomType::STANDARD, RoomType::L_SHAPE, RoomType::POLYGON };
+
+	TArray<ARoom*> Rooms;
+	for (int32 r = 0; r < NumActors; ++r)
+	{
+		ARoom* Room = SpawnRoom(Types[r % UE_ARRAY_COUNT(Types)]);
+		if (Room->Type == RoomType::POLYGON)
+			Room->Outline = MakeRandomOutline(Stream);
+
+		Room->bAsyncLayout			   = true;
+		Room->bProgressiveConstruction = r % 2 == 0;
+
+		Room->OnRoomConstructed.AddDynamic(this, &URoomLayoutBenchmarkCommandlet::HandleRoomConstructed);
+		Room->FinishSpawning(FTransform::Identity);
+
+		Rooms.Add(Room);
+	}
+
+	// Nothing is laid out before the subsystem runs, so no room may be constructed yet
+	if (ConstructedRooms.Num() > 0)
+		Failure = FString::Printf(TEXT("%s reported construction before its layout was solved"), *ConstructedRooms[0]->GetName());
+
+	Subsystem->Flush();
+
+	if (Failure.IsEmpty() && !ConstructedFailure.IsEmpty())
+		Failure = ConstructedFailure;
+	else if (Failure.IsEmpty() && ConstructedRooms.Num() != Rooms.Num())
+		Failure = FString::Printf(TEXT("%d of %d rooms reported construction"), ConstructedRooms.Num(), Rooms.Num());
+
+	// Edits of all rooms are solved together, rooms are checked after every flush
+	for (int32 op = 0; op < NumOps && Failure.IsEmpty(); ++op)
+	{
+		for (auto Room : Rooms)
+			ApplyRandomEdit(Room, Stream);
+
+		Subsystem->Flush();
+
+		for (int32 r = 0; r < Rooms.Num() && Failure.IsEmpty(); ++r)
+		{
+			if (!ValidateRoom(Rooms[r], Failure))
+				Failure = FString::Printf(TEXT("room %d op %d: %s"), r, op, *Failure);
+		}
+	}
+
+	for (auto Room : Rooms)
+		Room->Destroy();
+
+	EndSuiteWorld();
+
+	UE_LOG(LogTemp, Display, TEXT("RoomLayoutBenchmark: %d async rooms with %s walls, %d of them progressive, %d edits each"),
+		NumActors, WallModeNames[static_cast<int32>(WallMode)], (NumActors + 1) / 2, NumOps);
+
+	if (!Failure.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: %s"), *Failure);
+		return false;
+	}
+
+	return true;
+}
+
+bool URoomLayoutBenchmarkCommandlet::RunUndoSuite(const FString& Params)
+{
+	int32 NumActors		  = 20;
+	int32 NumOps		  = 200;
+	int32 Seed			  = 1;
+	int32 BudgetUndoBytes = 1024;
+
+	FParse::Value(*Params, TEXT("actors="), NumActors);
+	FParse::Value(*Params, TEXT("ops="), NumOps);
+	FParse::Value(*Params, TEXT("seed="), Seed);
+	FParse::Value(*Params, TEXT("budgetundobytes="), BudgetUndoBytes);
+
+	if (NumActors <= 0)
+		return true;
+
+	WallMode = ParseWallMode(Params);
+
+	if (!BeginSuiteWorld(TEXT("RoomUndoSuite")))
+		return false;
+
+	auto Subsystem = SuiteWorld->GetSubsystem<URoomLayoutSubsystem>();
+
+	FRandomStream Stream(Seed);
+	FString Failure;
+	int32 MaxStepBytes = 0;
+
+	// Last undo step must be the room as its rebuild left it, clamping included
+	auto checkHistory = [](ARoom* Room, FString& OutError)
+	{
+		if (Room->bUndoStepPending || Room->UndoStack.Num() == 0)
+		{
+			OutError = TEXT("applied edit has no undo step");
+			return false;
+		}
+
+		const auto& Last = Room->UndoStack.Last();
+		if (Last.Length != Room->Length || Last.Width != Room->Width || Last.Height != Room->Height
+			|| Last.CornerX != Room->cornerX || Last.CornerY != Room->cornerY || *Last.Outline != Room->Outline)
+		{
+			OutError = TEXT("last undo step is not the rebuilt room");
+			return false;
+		}
+
+		return true;
+	};
+
+	auto sameOpenings = [](const FWallOpenings& A, const FWallOpenings& B)
+	{
+		return A.Offsets == B.Offsets && A.Widths == B.Widths && A.Types == B.Types && A.MeshIndices == B.MeshIndices;
+	};
+
+	const RoomType Types[] = { RoomType::STANDARD, RoomType::L_SHAPE, RoomType::POLYGON };
+
+	for (int32 r = 0; r < NumActors && Failure.IsEmpty(); ++r)
+	{
+		ARoom* Room = SpawnRoom(Types[r % UE_ARRAY_COUNT(Types)]);
+		if (Room->Type == RoomType::POLYGON)
+			Room->Outline = MakeRandomOutline(Stream);
+
+		// Every other room is laid out in background, so its undo steps wait for the flush
+		Room->bAsyncLayout = Subsystem && r % 2 == 1;
+		Room->FinishSpawning(FTransform::Identity);
+
+		auto flush = [&]()
+		{
+			if (Room->bAsyncLayout)
+				Subsystem->Flush();
+		};
+
+		flush();
+
+		if (!Room->HasActorBegunPlay() || Room->Walls.Num() == 0)
+			Failure = FString::Printf(TEXT("room %d was not created"), r);
+
+		// Room after every edit that changed it, first one is the created room
+		TArray<TArray<uint8>> States;
+		Room->SaveToBytes(States.AddDefaulted_GetRef());
+
+		for (int32 op = 0; op < NumOps && Failure.IsEmpty(); ++op)
+		{
+			// Length below minimum is set right only by clamping in rebuild
+			if (op % 10 == 0)
+				Room->SetLength(0.0f);
+			else
+				ApplyRandomEdit(Room, Stream);
+
+			flush();
+
+			TArray<uint8> Saved;
+			Room->SaveToBytes(Saved);
+
+			if (Saved != States.Last())
+				States.Add(MoveTemp(Saved));
+
+			if (!checkHistory(Room, Failure))
+				Failure = FString::Printf(TEXT("room %d op %d: %s"), r, op, *Failure);
+		}
+
+		// Edits rejected or clamped back to the same room add no step
+		const int32 NumSteps = FMath::Min(States.Num() - 1, Room->MaxUndoSteps);
+
+		if (Failure.IsEmpty() && Room->UndoStack.Num() != NumSteps + 1)
+			Failure = FString::Printf(TEXT("room %d has %d undo steps for %d changes"), r, Room->UndoStack.Num() - 1, NumSteps);
+
+		if (Failure.IsEmpty() && NumSteps > 0)
+		{
+			// Oldest state is shared with the first step, so it is counted with the steps
+			const int32 StepBytes = Room->GetUndoHistorySize() / NumSteps;
+			MaxStepBytes = FMath::Max(MaxStepBytes, StepBytes);
+
+			if (StepBytes > BudgetUndoBytes)
+				Failure = FString::Printf(TEXT("room %d uses %d bytes per undo step, budget %d"), r, StepBytes, BudgetUndoBytes);
+		}
+
+		for (int32 step = 1; step <= NumSteps && Failure.IsEmpty(); ++step)
+		{
+			TArray<FWallOpenings> Openings;
+			TArray<FWallPlacement> Placements;
+
+			for (auto wall : Room->Walls)
+			{
+				Openings.Add(wall->Openings);
+				Placements.Add(wall->AppliedPlacement);
+			}
+
+			const float Height = Room->Height;
+			const int32 Rebuilt = Room->GetSegmentPoolStats().WallsRebuilt;
+
+			const bool bUndone = Room->Undo();
+			flush();
+
+			// Height resizes every segment, other walls are changed only by their openings or placement
+			int32 Changed = 0;
+			for (int32 idx = 0; idx < Room->Walls.Num(); ++idx)
+			{
+				auto wall = Room->Walls[idx];
+
+				if (Room->Height != Height || !Openings.IsValidIndex(idx) || !(Placements[idx] == wall->AppliedPlacement) || !sameOpenings(Openings[idx], wall->Openings))
+					Changed++;
+			}
+
+			TArray<uint8> Saved;
+			Room->SaveToBytes(Saved);
+
+			const int32 NumRebuilt = Room->GetSegmentPoolStats().WallsRebuilt - Rebuilt;
+
+			if (!bUndone || Saved != States[States.Num() - 1 - step])
+				Failure = FString::Printf(TEXT("room %d: undo %d does not restore its step"), r, step);
+			else if (!ValidateRoom(Room, Failure))
+				Failure = FString::Printf(TEXT("room %d undo %d: %s"), r, step, *Failure);
+			else if (NumRebuilt > Changed)
+				Failure = FString::Printf(TEXT("room %d: undo %d rebuilt %d walls, %d changed"), r, step, NumRebuilt, Changed);
+		}
+
+		// Redo goes back to edited room
+		for (int32 step = 0; step < NumSteps && Failure.IsEmpty(); ++step)
+		{
+			Room->Redo();
+			flush();
+		}
+
+		if (Failure.IsEmpty())
+		{
+			TArray<uint8> Saved;
+			Room->SaveToBytes(Saved);
+
+			if (Room->CanRedo() || Saved != States.Last())
+				Failure = FString::Printf(TEXT("room %d: redo does not end in edited room"), r);
+			else if (!ValidateRoom(Room, Failure))
+				Failure = FString::Printf(TEXT("room %d after redo: %s"), r, *Failure);
+		}
+
+		Room->Destroy();
+	}
+
+	EndSuiteWorld();
+
+	UE_LOG(LogTemp, Display, TEXT("RoomLayoutBenchmark: %d rooms with %s walls undone and redone, up to %d bytes per undo step"),
+		NumActors, WallModeNames[static_cast<int32>(WallMode)], MaxStepBytes);
+
+	if (!Failure.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: %s"), *Failure);
+		return false;
+	}
+
+	return true;
+}
+
+bool URoomLayoutBenchmarkCommandlet::RunFloorPlanSuite(const FString& Params)
+{
+	if (!BeginSuiteWorld(TEXT("FloorPlanSuite")))
+		return false;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.bDeferConstruction = true;
+
+	AFloorPlan* Plan = SuiteWorld->SpawnActor<AFloorPlan>(AFloorPlan::StaticClass(), FTransform::Identity, SpawnParams);
+
+	Plan->WallMesh		= WallMesh;
+	Plan->FloorMesh		= FloorMesh;
+	Plan->CeilingMesh	= CeilingMesh;
+	Plan->DoorMeshes	= { DoorMesh };
+	Plan->WindowMeshes	= { WindowMesh };
+
+	Plan->FinishSpawning(FTransform::Identity);
+
+	FString Failure;
+
+	// Door in first and window in second half of every wall, east wall is split in halves by added rooms
+	const float Size = 600.0f;
+	Plan->AddRoom(FBox2D(FVector2D(0.0f, 0.0f), FVector2D(Size * 2.0f, Size)));
+
+	for (auto wall : Plan->GetRoomWalls(0))
+	{
+		Plan->AddObjectToWall(wall, wall->Length * 0.25f, ObjectType::DOOR);
+		Plan->AddObjectToWall(wall, wall->Length * 0.75f, ObjectType::WINDOW);
+	}
+
+	auto sortedOpenings = [Plan]()
+	{
+		auto Openings = Plan->ExportDescription().Openings;
+
+		Openings.Sort([](const FFloorPlanOpeningDescription& A, const FFloorPlanOpeningDescription& B)
+		{
+			if (A.Axis != B.Axis)
+				return A.Axis < B.Axis;
+
+			return A.Line != B.Line ? A.Line < B.Line : A.Position < B.Position;
+		});
+
+		return Openings;
+	};
+
+	const auto Initial = sortedOpenings();
+	const int32 NumWalls = Plan->GetRoomWalls(0).Num();
+
+	if (Initial.Num() != NumWalls * 2)
+		Failure = FString::Printf(TEXT("floor plan room has %d objects on %d walls"), Initial.Num(), NumWalls);
+
+	// Object on east wall at position along its line must be on a wall of both rooms
+	auto isShared = [Plan, Size](float Position, int32 Room)
+	{
+		const int32 idx = FloorPlanLayout::FindWall(Plan->Graph, EFloorPlanAxis::Y, FMath::RoundToInt(Size * 2.0f), Position);
+
+		return idx != INDEX_NONE && Plan->Graph[idx].HasRoom(0) && Plan->Graph[idx].HasRoom(Room) && Plan->Walls[idx]->Openings.Num() == 1;
+	};
+
+	auto checkStep = [&](const TCHAR* Step)
+	{
+		if (!Failure.IsEmpty())
+			return;
+
+		const auto Openings = sortedOpenings();
+
+		bool bSame = Openings.Num() == Initial.Num();
+		for (int32 idx = 0; idx < Openings.Num() && bSame; ++idx)
+		{
+			const auto& A = Openings[idx];
+			const auto& B = Initial[idx];
+
+			bSame = A.Axis == B.Axis && A.Line == B.Line && A.Type == B.Type && A.MeshIndex == B.MeshIndex && FMath::IsNearlyEqual(A.Position, B.Position, 0.01f);
+		}
+
+		if (!ValidateFloorPlan(Plan, Failure))
+			Failure = FString::Printf(TEXT("floor plan after %s: %s"), Step, *Failure);
+		else if (!bSame)
+			Failure = FString::Printf(TEXT("floor plan after %s has %d objects, the %d added ones are not all at their place"), Step, Openings.Num(), Initial.Num());
+	};
+
+	checkStep(TEXT("adding objects"));
+
+	// Room next to south half splits east wall, its object is shared by both rooms
+	Plan->AddRoom(FBox2D(FVector2D(Size * 2.0f, 0.0f), FVector2D(Size * 3.0f, Size / 2.0f)));
+	checkStep(TEXT("adding room"));
+
+	if (Failure.IsEmpty() && !isShared(Size / 4.0f, 1))
+		Failure = TEXT("object on split wall is not shared with added room");
+
+	Plan->AddRoom(FBox2D(FVector2D(Size * 2.0f, Size / 2.0f), FVector2D(Size * 3.0f, Size)));
+	checkStep(TEXT("adding second room"));
+
+	if (Failure.IsEmpty() && !isShared(Size * 0.75f, 2))
+		Failure = TEXT("object on split wall is not shared with second added room");
+
+	// Halves of east wall are merged again once both rooms are gone
+	Plan->RemoveRoom(1);
+	checkStep(TEXT("removing room"));
+
+	Plan->RemoveRoom(1);
+	checkStep(TEXT("removing second room"));
+
+	if (Failure.IsEmpty() && Plan->GetRoomWalls(0).Num() != NumWalls)
+		Failure = FString::Printf(TEXT("floor plan room has %d walls after rooms were removed, %d before"), Plan->GetRoomWalls(0).Num(), NumWalls);
+
+	Plan->Destroy();
+
+	EndSuiteWorld();
+
+	UE_LOG(LogTemp, Display, TEXT("RoomLayoutBenchmark: floor plan with %d objects split and merged"), Initial.Num());
+
+	if (!Failure.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("RoomLayoutBenchmark: %s"), *Failure);
+		return false;
+	}
+
+	return true;
+}
+
+bool URoomLayoutBenchmarkCommandlet::ValidateRoom(ARoom* Room, FString& OutError) const
+{
+	const auto Settings = Room->GetLayoutSettings();
+
+	auto toSegments = [](const TArray<TWeakObjectPtr<UStaticMeshComponent>>& Components, TArray<FSegmentTransform>& OutSegments)
+	{
+		for (const auto& component : Components)
+		{
+			if (!component.IsValid())
+				return false;
+
+			FSegmentTransform& Segment = OutSegments.AddDefaulted_GetRef();
+			Segment.Location = component->GetRelativeLocation();
+			Segment.Scale	 = component->GetRelativeScale3D();
+		}
+
+		return true;
+	};
+
+	int32 NumSegments = 0;
+
+	TArray<FWallPlacement> Placements;
+	RoomLayout::ComputeWallPlacements(Settings, Placements);
+
+	if (Placements.Num() != Room->Walls.Num())
+	{
+		OutError = FString::Printf(TEXT("room has %d walls, outline has %d edges"), Room->Walls.Num(), Placements.Num());
+		return false;
+	}
+
+	const int32 LODLevel = Room->GetLODLevel();
+
+	// Instances are corners first, then segments of every wall or one box per wall of simplified room
+	TArray<FTransform> Instances;
+
+	if (Room->bUseInstancedSegments)
+	{
+		FSurfaceLayout Surfaces;
+		RoomLayout::ComputeSurfaces(Settings, Surfaces);
+
+		for (const auto& corner : Surfaces.Corners)
+			Instances.Add(FTransform(FRotator::ZeroRotator, corner.Location, corner.Scale));
+	}
+
+	for (int32 w = 0; w < Room->Walls.Num(); ++w)
+	{
+		auto wall = Room->Walls[w];
+
+		FWallLayout Layout;
+
+		if (Room->bUseInstancedSegments || Room->bUseProceduralWalls)
+		{
+			// Segments are not components here, applied layout is checked and instances or mesh are compared with it
+			if (wall->HorizontalSegments.Num() + wall->VerticalSegments.Num() > 0)
+			{
+				OutError = FString::Printf(TEXT("%s keeps segment components"), *wall->GetName());
+				return false;
+			}
+
+			Layout = wall->AppliedLayout;
+		}
+		else
+		{
+			Layout.Openings = wall->AppliedLayout.Openings;
+
+			if (!toSegments(wall->HorizontalSegments, Layout.HorizontalSegments) || !toSegments(wall->VerticalSegments, Layout.VerticalSegments))
+			{
+				OutError = FString::Printf(TEXT("%s has destroyed segment"), *wall->GetName());
+				return false;
+			}
+
+			NumSegments += Layout.HorizontalSegments.Num() + Layout.VerticalSegments.Num();
+		}
+
+		// Wall must follow current room dimensions
+		const auto& Placement = Placements[w];
+		if (!(Placement == wall->AppliedPlacement))
+		{
+			OutError = FString::Printf(TEXT("%s is not placed for current room dimensions"), *wall->GetName());
+			return false;
+		}
+
+		FString Error;
+		if (!RoomLayout::ValidateWallLayout(Settings, Placement, wall->Openings, Layout, Error))
+		{
+			OutError = FString::Printf(TEXT("%s: %s"), *wall->GetName(), *Error);
+			return false;
+		}
+
+		// Object components only mirror the opening arrays
+		if (wall->Objects.Num() != wall->Openings.Num())
+		{
+			OutError = FString::Printf(TEXT("%s has %d objects for %d openings"), *wall->GetName(), wall->Objects.Num(), wall->Openings.Num());
+			return false;
+		}
+
+		// Openings read back from components, as layout read them before the opening arrays
+		FWallOpenings fromObjects;
+
+		for (int32 idx = 0; idx < wall->Objects.Num(); ++idx)
+		{
+			auto obj = wall->Objects[idx];
+			if (!IsValid(obj) || obj->offset != wall->Openings.Offsets[idx])
+			{
+				OutError = FString::Printf(TEXT("%s object %d does not match its opening"), *wall->GetName(), idx);
+				return false;
+			}
+
+			const auto& Meshes = obj->type == ObjectType::DOOR ? Room->DoorMeshes : Room->WindowMeshes;
+			if (!Meshes.IsValidIndex(wall->Openings.MeshIndices[idx]) || Meshes[wall->Openings.MeshIndices[idx]] != obj->GetStaticMesh())
+			{
+				OutError = FString::Printf(TEXT("%s object %d does not show mesh of its opening"), *wall->GetName(), idx);
+				return false;
+			}
+
+			const FVector Dimensions = obj->GetDimensions();
+
+			FLayoutOpening opening;
+			opening.Offset = obj->offset;
+			opening.Width  = Dimensions.Y;
+			opening.Height = Dimensions.Z;
+			opening.Type   = obj->type == ObjectType::WINDOW ? ELayoutOpeningType::Window : ELayoutOpeningType::Door;
+
+			fromObjects.Add(opening, wall->Openings.MeshIndices[idx]);
+		}
+
+		// Applied wall must be the layout of the component openings as well
+		if (!RoomLayout::ValidateWallLayout(Settings, Placement, fromObjects, Layout, Error))
+		{
+			OutError = FString::Printf(TEXT("%s differs from layout of its objects: %s"), *wall->GetName(), *Error);
+			return false;
+		}
+
+		if (Room->bUseProceduralWalls)
+		{
+			FWallMeshData Mesh;
+			RoomLayout::BuildWallMesh(Settings, Placement, wall->Openings, Layout, Room->WallUVSize, Mesh);
+
+			if (!ValidateMeshSection(wall->ProceduralMesh, 0, Mesh, Error))
+			{
+				OutError = FString::Printf(TEXT("%s: %s"), *wall->GetName(), *Error);
+				return false;
+			}
+		}
+
+		if (Room->bUseInstancedSegments)
+		{
+			const FTransform WallTransform = wall->GetRelativeTransform();
+
+			if (LODLevel > 0)
+			{
+				Instances.Add(FTransform(FRotator::ZeroRotator, FVector::ZeroVector, FVector(1.0f, Placement.Length, Settings.Height)) * WallTransform);
+			}
+			else
+			{
+				for (const auto& segment : Layout.HorizontalSegments)
+					Instances.Add(FTransform(FRotator::ZeroRotator, segment.Location, segment.Scale) * WallTransform);
+
+				for (const auto& segment : Layout.VerticalSegments)
+					Instances.Add(FTransform(FRotator::ZeroRotator, segment.Location, segment.Scale) * WallTransform);
+			}
+		}
+		else if (LODLevel == 1 && !IsValid(wall->LODBox))
+		{
+			OutError = FString::Printf(TEXT("%s has no box for LOD 1"), *wall->GetName());
+			return false;
+		}
+	}
+
+	if (Room->GetSegmentPoolStats().Live != NumSegments)
+	{
+		OutError = FString::Printf(TEXT("%d live segments, walls use %d"), Room->GetSegmentPoolStats().Live, NumSegments);
+		return false;
+	}
+
+	if (Room->bUseInstancedSegments)
+	{
+		const int32 NumInstances = IsValid(Room->WallInstances) ? Room->WallInstances->GetInstanceCount() : 0;
+		if (NumInstances != Instances.Num())
+		{
+			OutError = FString::Printf(TEXT("%d wall instances, solved layout has %d"), NumInstances, Instances.Num());
+			return false;
+		}
+
+		for (int32 idx = 0; idx < NumInstances; ++idx)
+		{
+			FTransform Instance;
+			if (!Room->WallInstances->GetInstanceTransform(idx, Instance) || !Instance.Equals(Instances[idx], 0.01f))
+			{
+				OutError = FString::Printf(TEXT("wall instance %d is not at its solved transform"), idx);
+				return false;
+			}
+		}
+	}
+
+	// Merged room mesh must have walls of current room
+	if (LODLevel == 2)
+	{
+		FWallMeshData Mesh;
+		RoomLayout::BuildMergedWallMesh(Settings, Placements, Room->WallUVSize, Mesh);
+
+		FString Error;
+		if (!ValidateMeshSection(Room->RoomProxy, 0, Mesh, Error))
+		{
+			OutError = FString::Printf(TEXT("merged room: %s"), *Error);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool URoomLayoutBenchmarkCommandlet::ValidateFloorPlan(AFloorPlan* Plan, FString& OutError) const
+{
+	const auto Settings = Plan->GetLayoutSettings();
+
+	if (Plan->Walls.Num() != Plan->Graph.Num())
+	{
+		OutError = FString::Printf(TEXT("floor plan has %d walls, graph has %d"), Plan->Walls.Num(), Plan->Graph.Num());
+		return false;
+	}
+
+	for (int32 idx = 0; idx < Plan->Walls.Num(); ++idx)
+	{
+		auto wall = Plan->Walls[idx];
+		if (!IsValid(wall))
+		{
+			OutError = FString::Printf(TEXT("wall %d was destroyed"), idx);
+			return false;
+		}
+
+		const auto Placement = FloorPlanLayout::ComputeWallPlacement(Settings, Plan->Graph[idx]);
+		if (!(Placement == wall->AppliedPlacement))
+		{
+			OutError = FString::Printf(TEXT("%s is not placed for its edge"), *wall->GetName());
+			return false;
+		}
+
+		// Objects moved from split or merged walls must keep aligment from wall ends and each other
+		FString Error;
+		if (!ValidateFill(wall->Openings, Placement.Length, Settings.AligmentOffset, 0.0f, 0, TArray<float>(), Error)
+			|| !RoomLayout::ValidateWallLayout(Settings, Placement, wall->Openings, wall->AppliedLayout, Error))
+		{
+			OutError = FString::Printf(TEXT("%s: %s"), *wall->GetName(), *Error);
+			return false;
+		}
+
+		if (wall->Objects.Num() != wall->Openings.Num())
+		{
+			OutError = FString::Printf(TEXT("%s has %d objects for %d openings"), *wall->GetName(), wall->Objects.Num(), wall->Openings.Num());
+			return false;
+		}
+
+		for (int32 obj = 0; obj < wall->Objects.Num(); ++obj)
+		{
+			auto object = wall->Objects[obj];
+			if (!IsValid(object) || object->offset != wall->Openings.Offsets[obj] || object->GetAttachParent() != wall || object->GetOuter() != wall)
+			{
+				OutError = FString::Printf(TEXT("%s object %d does not belong to its opening"), *wall->GetName(), obj);
+				return false;
+			}
+		}
+
+		FWallMeshData Mesh;
+		RoomLayout::BuildWallMesh(Settings, Placement, wall->Openings, wall->AppliedLayout, Plan->WallUVSize, Mesh);
+
+		if (!ValidateMeshSection(wall->ProceduralMesh, 0, Mesh, Error))
+		{
+			OutError = FString::Printf(TEXT("%s: %s"), *wall->GetName(), *Error);
+			return false;
+		}
+	}
+
+	return true;
+}
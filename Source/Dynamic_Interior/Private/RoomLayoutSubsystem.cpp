@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RoomLayoutSubsystem.h"
+#include "Room.h"
+#include "DynamicInteriorStats.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+void URoomLayoutSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &URoomLayoutSubsystem::OnWorldPostActorTick);
+}
+
+void URoomLayoutSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	// Workers write into Jobs, so they must finish before it is freed
+	if (SolveTask.IsValid())
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(SolveTask);
+
+	SolveTask = nullptr;
+	Jobs.Reset();
+	QueuedRooms.Reset();
+	ConstructedRooms.Reset();
+	LODRooms.Reset();
+
+	Super::Deinitialize();
+}
+
+void URoomLayoutSubsystem::QueueConstruction(ARoom* room)
+{
+	if (IsValid(room))
+		ConstructedRooms.AddUnique(room);
+}
+
+void URoomLayoutSubsystem::RegisterLODRoom(ARoom* room)
+{
+	if (IsValid(room))
+		LODRooms.AddUnique(room);
+}
+
+void URoomLayoutSubsystem::UnregisterLODRoom(ARoom* room)
+{
+	LODRooms.Remove(room);
+}
+
+void URoomLayoutSubsystem::UpdateLOD(FVector viewLocation)
+{
+	LODTimer = 0.0f;
+
+	for (int32 idx = LODRooms.Num() - 1; idx >= 0; --idx)
+	{
+		auto room = LODRooms[idx].Get();
+		if (!IsValid(room))
+		{
+			LODRooms.RemoveAtSwap(idx);
+			continue;
+		}
+
+		if (!room->IsRoomConstructed())
+			continue;
+
+		// Distance to room box, so large rooms switch by their nearest wall
+		const FVector local = room->GetActorTransform().InverseTransformPosition(viewLocation);
+		const float distance = FMath::Sqrt(room->LocalBounds.ComputeSquaredDistanceToPoint(local));
+
+		room->SetLODLevel(room->GetLODForDistance(distance, LODHysteresis));
+	}
+}
+
+void URoomLayoutSubsystem::QueueRoom(ARoom* room)
+{
+	if (IsValid(room))
+		QueuedRooms.AddUnique(room);
+}
+
+void URoomLayoutSubsystem::QueueRooms(const TArray<ARoom*>& rooms)
+{
+	QueuedRooms.Reserve(QueuedRooms.Num() + rooms.Num());
+
+	for (auto room : rooms)
+		QueueRoom(room);
+}
+
+bool URoomLayoutSubsystem::IsIdle() const
+{
+	return ConstructedRooms.Num() == 0 && QueuedRooms.Num() == 0 && Jobs.Num() == 0;
+}
+
+void URoomLayoutSubsystem::Flush()
+{
+	// Constructed rooms may queue their first layout
+	ConstructRooms(-1.0);
+
+	// Rooms queued again by stale results are picked up by the next batch
+	while (!IsIdle())
+	{
+		if (Jobs.Num() == 0)
+			StartBatch();
+
+		if (SolveTask.IsValid())
+			FTaskGraphInterface::Get().WaitUntilTaskCompletes(SolveTask);
+
+		ApplyBatch(-1.0);
+	}
+}
+
+void URoomLayoutSubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld())
+		return;
+
+	if (ConstructedRooms.Num() > 0)
+		ConstructRooms(ConstructionBudgetMs / 1000.0);
+
+	LODTimer += DeltaSeconds;
+
+	if (LODRooms.Num() > 0 && LODTimer >= LODUpdateInterval)
+	{
+		auto controller = World->GetFirstPlayerController();
+
+		if (controller && controller->PlayerCameraManager)
+			UpdateLOD(controller->PlayerCameraManager->GetCameraLocation());
+	}
+
+	if (Jobs.Num() > 0 && IsBatchSolved())
+		ApplyBatch(ApplyBudgetMs / 1000.0);
+
+	// Rooms queued during this frame start solving while previous batch is still applied
+	if (Jobs.Num() == 0 && QueuedRooms.Num() > 0)
+		StartBatch();
+}
+
+void URoomLayoutSubsystem::ConstructRooms(double BudgetSeconds)
+{
+	const double Start = FPlatformTime::Seconds();
+
+	while (NextConstructed < ConstructedRooms.Num())
+	{
+		auto room = ConstructedRooms[NextConstructed].Get();
+
+		// Destroyed rooms and rooms built by CreateRoom meanwhile are skipped
+		if (!IsValid(room) || room->ConstructionStep == INDEX_NONE || room->ConstructNextStep())
+			NextConstructed++;
+
+		if (BudgetSeconds >= 0.0 && FPlatformTime::Seconds() - Start >= BudgetSeconds)
+			break;
+	}
+
+	if (NextConstructed < ConstructedRooms.Num())
+		return;
+
+	ConstructedRooms.Reset();
+	NextConstructed = 0;
+}
+
+void URoomLayoutSubsystem::StartBatch()
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_StartLayoutBatch);
+
+	Jobs.Reset(QueuedRooms.Num());
+	NextApply = 0;
+
+	// Snapshot is taken on game thread, workers never touch rooms
+	for (auto& room : QueuedRooms)
+	{
+		if (!room.IsValid() || !room->IsRoomConstructed())
+			continue;
+
+		FRoomJob& Job = Jobs.AddDefaulted_GetRef();
+		Job.Room		 = room;
+		Job.Revision	 = room->LayoutRevision;
+		Job.bBuildMeshes = room->bUseProceduralWalls;
+		Job.UVSize		 = room->WallUVSize;
+
+		room->GatherLayoutInput(Job.Input);
+	}
+
+	QueuedRooms.Reset();
+
+	if (Jobs.Num() == 0)
+		return;
+
+	SolveTask = FFunctionGraphTask::CreateAndDispatchWhenReady([this]()
+		{
+			ParallelFor(Jobs.Num(), [this](int32 idx)
+				{
+					DYNAMIC_INTERIOR_SCOPE(STAT_SolveRoom);
+
+					auto& Job = Jobs[idx];
+
+					RoomLayout::SolveRoom(Job.Input, Job.Result);
+
+					if (!Job.bBuildMeshes)
+						return;
+
+					Job.Meshes.SetNum(Job.Result.Walls.Num());
+
+					for (int32 wall = 0; wall < Job.Result.Walls.Num(); ++wall)
+						RoomLayout::BuildWallMesh(Job.Result.Settings, Job.Result.Placements[wall], Job.Input.Walls[wall].Openings, Job.Result.Walls[wall], Job.UVSize, Job.Meshes[wall]);
+				});
+		}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+}
+
+bool URoomLayoutSubsystem::IsBatchSolved() const
+{
+	return !SolveTask.IsValid() || SolveTask->IsComplete();
+}
+
+void URoomLayoutSubsystem::ApplyBatch(double BudgetSeconds)
+{
+	DYNAMIC_INTERIOR_SCOPE(STAT_ApplyLayoutBatch);
+
+	const double Start = FPlatformTime::Seconds();
+
+	while (NextApply < Jobs.Num())
+	{
+		auto& Job = Jobs[NextApply++];
+		auto room = Job.Room.Get();
+
+		// Room was edited after snapshot, the edit rebuilt or queued it again
+		if (IsValid(room) && room->LayoutRevision == Job.Revision)
+			room->ApplySolvedLayout(Job.Result, Job.Meshes);
+
+		if (BudgetSeconds >= 0.0 && FPlatformTime::Seconds() - Start >= BudgetSeconds)
+			break;
+	}
+
+	if (NextApply < Jobs.Num())
+		return;
+
+	Jobs.Reset();
+	SolveTask = nullptr;
+	NextApply = 0;
+}
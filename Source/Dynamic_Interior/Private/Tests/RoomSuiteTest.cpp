@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RoomLayoutBenchmarkCommandlet.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Counts are kept small so tests finish in seconds, the commandlet runs full sized suite
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRoomLayoutTest, "DynamicInterior.Layout", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRoomSuiteTest, "DynamicInterior.Rooms", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRoomAsyncSuiteTest, "DynamicInterior.AsyncRooms", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRoomUndoSuiteTest, "DynamicInterior.Undo", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRoomInstancedSuiteTest, "DynamicInterior.InstancedRooms", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRoomProceduralSuiteTest, "DynamicInterior.ProceduralRooms", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFloorPlanSuiteTest, "DynamicInterior.FloorPlan", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRoomLayoutTest::RunTest(const FString& Parameters)
+{
+	auto Commandlet = NewObject<URoomLayoutBenchmarkCommandlet>();
+	return TestTrue(TEXT("Solved walls are valid"), Commandlet->RunLayoutBenchmark(TEXT("-rooms=500 -seed=1")));
+}
+
+bool FRoomSuiteTest::RunTest(const FString& Parameters)
+{
+	auto Commandlet = NewObject<URoomLayoutBenchmarkCommandlet>();
+	return TestTrue(TEXT("Edited rooms are valid and within budget"), Commandlet->RunRoomSuite(TEXT("-actors=6 -ops=100 -seed=1")));
+}
+
+bool FRoomAsyncSuiteTest::RunTest(const FString& Parameters)
+{
+	auto Commandlet = NewObject<URoomLayoutBenchmarkCommandlet>();
+	return TestTrue(TEXT("Rooms built and laid out in background are valid"), Commandlet->RunAsyncSuite(TEXT("-actors=6 -ops=20 -seed=1")));
+}
+
+bool FRoomUndoSuiteTest::RunTest(const FString& Parameters)
+{
+	auto Commandlet = NewObject<URoomLayoutBenchmarkCommandlet>();
+	return TestTrue(TEXT("Undo and redo restore edited rooms and rebuild only changed walls"), Commandlet->RunUndoSuite(TEXT("-actors=6 -ops=60 -seed=1")));
+}
+
+// Same edits as default rooms, walls drawn as instances or one mesh per wall
+bool FRoomInstancedSuiteTest::RunTest(const FString& Parameters)
+{
+	auto Commandlet = NewObject<URoomLayoutBenchmarkCommandlet>();
+
+	TestTrue(TEXT("Edited instanced rooms are valid and within budget"), Commandlet->RunRoomSuite(TEXT("-actors=6 -ops=100 -seed=1 -walls=instanced")));
+	TestTrue(TEXT("Instanced rooms laid out in background are valid"), Commandlet->RunAsyncSuite(TEXT("-actors=6 -ops=20 -seed=1 -walls=instanced")));
+	TestTrue(TEXT("Undo and redo restore instanced rooms"), Commandlet->RunUndoSuite(TEXT("-actors=6 -ops=60 -seed=1 -walls=instanced")));
+
+	return !HasAnyErrors();
+}
+
+bool FRoomProceduralSuiteTest::RunTest(const FString& Parameters)
+{
+	auto Commandlet = NewObject<URoomLayoutBenchmarkCommandlet>();
+
+	TestTrue(TEXT("Edited procedural rooms are valid and within budget"), Commandlet->RunRoomSuite(TEXT("-actors=6 -ops=100 -seed=1 -walls=procedural")));
+	TestTrue(TEXT("Procedural rooms laid out in background are valid"), Commandlet->RunAsyncSuite(TEXT("-actors=6 -ops=20 -seed=1 -walls=procedural")));
+	TestTrue(TEXT("Undo and redo restore procedural rooms"), Commandlet->RunUndoSuite(TEXT("-actors=6 -ops=60 -seed=1 -walls=procedural")));
+
+	return !HasAnyErrors();
+}
+
+bool FFloorPlanSuiteTest::RunTest(const FString& Parameters)
+{
+	auto Commandlet = NewObject<URoomLayoutBenchmarkCommandlet>();
+	return TestTrue(TEXT("Objects of split and merged floor plan walls stay at their place"), Commandlet->RunFloorPlanSuite(TEXT("")));
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "WallComponent.h"
 #include "UObject/UObjectGlobals.h"
+#include "Algo/BinarySearch.h"
 
 // Sets default values for this component's properties
 UWallComponent::UWallComponent()
@@ -23,21 +24,74 @@ UWallComponent::UWallComponent()
 void UWallComponent::BeginPlay()
 {
 	Super::BeginPlay();
+}
 
-	BoundingBox = NewObject<UBoxComponent>(this, UBoxComponent::StaticClass(), NAME_None);
-	BoundingBox->SetWorldScale3D(FVector(1.0));
-	BoundingBox->SetHiddenInGame(false);
-	BoundingBox->SetBoxExtent(FVector(50.0f));
+UBoxComponent* UWallComponent::UpdateBoundingBox()
+{
+	// Box is created when picking needs it first time
+	if (!IsValid(BoundingBox))
+	{
+		BoundingBox = NewObject<UBoxComponent>(this, UBoxComponent::StaticClass(), NAME_None);
+		BoundingBox->SetWorldScale3D(FVector(1.0));
+		BoundingBox->SetHiddenInGame(false);
+		BoundingBox->SetBoxExtent(FVector(50.0f));
 
-	static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
-	BoundingBox->AttachToComponent(this, rules);
-	
-	BoundingBox->RegisterComponent();
-	BoundingBox->SetRelativeLocation(FVector(0.0));
+		static FAttachmentTransformRules rules(EAttachmentRule::KeepRelative, false);
+		BoundingBox->AttachToComponent(this, rules);
+
+		BoundingBox->RegisterComponent();
+		BoundingBox->SetCollisionProfileName(FName("BlockAll"));
+	}
+
+	BoundingBox->SetRelativeLocation(AppliedPlacement.Bounds.Location);
+	BoundingBox->SetRelativeScale3D(AppliedPlacement.Bounds.Scale);
+
+	return BoundingBox;
+}
+
+int32 UWallComponent::AddObject(UObjectComponent* obj, const FLayoutOpening& opening, int32 meshIndex)
+{
+	const int32 index = RoomLayout::FindOpeningAfter(Openings, opening.Offset);
+
+	Openings.Insert(index, opening, meshIndex);
+	Objects.Insert(obj, index);
+
+	return index;
+}
+
+bool UWallComponent::RemoveObject(UObjectComponent* obj)
+{
+	const int32 index = FindObjectIndex(obj);
+	if (index == INDEX_NONE)
+		return false;
 
-	BoundingBox->SetCollisionProfileName(FName("BlockAll"));
+	Openings.RemoveAt(index);
+	Objects.RemoveAt(index);
+
+	return true;
 }
 
+int32 UWallComponent::FindObjectIndex(const UObjectComponent* obj) const
+{
+	if (!obj)
+		return INDEX_NONE;
+
+	// Objects with same offset are next to each other
+	for (int32 index = Algo::LowerBound(Openings.Offsets, obj->offset); index < Openings.Num() && Openings.Offsets[index] == obj->offset; ++index)
+	{
+		if (Objects[index] == obj)
+			return index;
+	}
+
+	// Offset was changed outside of wall
+	return Objects.Find(const_cast<UObjectComponent*>(obj));
+}
+
+void UWallComponent::SetObjectOffset(int32 index, float offset)
+{
+	Openings.Offsets[index] = offset;
+	Objects[index]->offset = offset;
+}
 
 // Called every frame
 void UWallComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
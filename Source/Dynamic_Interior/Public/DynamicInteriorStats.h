@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Use "stat DynamicInterior" to view. Headless runs record the same scopes to Unreal Insights
+// with -trace=cpu,stats -tracefile=<path>, scopes are traced even in builds without stats.
+DECLARE_STATS_GROUP(TEXT("DynamicInterior"), STATGROUP_DynamicInterior, STATCAT_Advanced);
+
+// Cycle counter for the rest of the scope, it is also traced as Insights CPU event.
+// Builds without stats trace a CPU event of the same name instead.
+#if STATS
+#define DYNAMIC_INTERIOR_SCOPE(Stat) SCOPE_CYCLE_COUNTER(Stat)
+#else
+#define DYNAMIC_INTERIOR_SCOPE(Stat) TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+#endif
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Walls rebuilt"), STAT_WallsRebuilt, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+
+// Spawned rooms and rooms with enabled tick, ticking rooms should stay zero
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Rooms"), STAT_Rooms, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Ticking rooms"), STAT_TickingRooms, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+
+// Components of all rooms, per room counts are returned by ARoom::GetSegmentPoolStats
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live segments"), STAT_LiveSegments, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pooled segments"), STAT_PooledSegments, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Objects"), STAT_Objects, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+
+// Approximate, sizeof of component objects only. Body instances, render proxies and other
+// allocations owned by components are not included, meshes are shared and counted by the engine.
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Segment components (approx.)"), STAT_ApproxSegmentMemory, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Object components (approx.)"), STAT_ApproxObjectMemory, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+
+// Room pipeline
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CreateRoom"), STAT_CreateRoom, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ConstructNextStep"), STAT_ConstructNextStep, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateAllWalls"), STAT_UpdateAllWalls, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateWall"), STAT_UpdateWall, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RebuildDirty"), STAT_RebuildDirty, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PrepareWallSegments"), STAT_PrepareWallSegments, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ClampDimensions"), STAT_ClampDimensions, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateFloor"), STAT_UpdateFloor, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplySurfaces"), STAT_ApplySurfaces, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AddObjectToWall"), STAT_AddObjectToWall, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FillWallWithObjects"), STAT_FillWallWithObjects, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyLOD"), STAT_ApplyLOD, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+
+// Background layout, solving runs on worker threads
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gather layout batch"), STAT_StartLayoutBatch, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solve room"), STAT_SolveRoom, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply layout batch"), STAT_ApplyLayoutBatch, STATGROUP_DynamicInterior, DYNAMIC_INTERIOR_API);
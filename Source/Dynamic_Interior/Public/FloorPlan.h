@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InteriorActor.h"
+#include "FloorPlanLayout.h"
+
+#include "FloorPlan.generated.h"
+
+// Door or window in saved floor plan, placed by center line of its wall instead of wall index
+USTRUCT(BlueprintType)
+struct FFloorPlanOpeningDescription
+{
+	GENERATED_BODY()
+
+	// EFloorPlanAxis of the wall and its center line coordinate
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	uint8 Axis = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Line = 0;
+
+	// Position of the left side of the object along center line
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Position = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ObjectType Type = ObjectType::DOOR;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MeshIndex = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FFloorPlanDescription
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Height = 290.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FBox2D> Rooms;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FFloorPlanOpeningDescription> Openings;
+};
+
+/**
+ * Apartment made of many rectangular rooms.
+ *
+ * Unlike ARoom every wall here may be shared by two rooms: a partition is built once as a single
+ * procedural mesh and its doors serve both sides. Changing a room only rebuilds walls whose
+ * edges or length changed, the rest of the plan keeps its components.
+ */
+UCLASS()
+class DYNAMIC_INTERIOR_API AFloorPlan : public AInteriorActor
+{
+	GENERATED_BODY()
+
+	// Headless suite checks wall components against the graph
+	friend class URoomLayoutBenchmarkCommandlet;
+
+public:
+	// Sets default values for this actor's properties
+	AFloorPlan();
+
+protected:
+
+	// Room rectangles on wall center lines, touching rooms share walls
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties")
+	TArray<FBox2D> Rooms;
+
+	// Height, meshes and offsets are shared with ARoom in AInteriorActor
+
+	// Shared walls, same order as Graph
+	TArray<FFloorPlanWall> Graph;
+
+	UPROPERTY()
+	TArray<UWallComponent*> Walls;
+
+	// One floor and ceiling per room, same order as Rooms
+	UPROPERTY()
+	TArray<UStaticMeshComponent*> Floors;
+
+	UPROPERTY()
+	TArray<UStaticMeshComponent*> Ceilings;
+
+	// Rooms and settings used by last rebuild
+	TArray<FBox2D> AppliedRooms;
+	FRoomLayoutSettings AppliedSettings;
+	bool bHasAppliedSettings = false;
+
+	// Description set before begin play, plan is built from it instead of Rooms
+	FFloorPlanDescription PendingDescription;
+	bool bHasPendingDescription = false;
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Rebuild wall graph, keep components of unchanged edges and move openings of split or merged walls
+	void UpdateGraph();
+
+	// Shift openings of kept wall by corner change and fit them on its new length, objects that do not fit are removed
+	void FitWallObjects(UWallComponent* wall, float Shift, float NewLength);
+
+	// Rebuild walls and surfaces changed since last rebuild
+	void RebuildDirty();
+
+	void ApplyWallPlacement(UWallComponent* wall, const FWallPlacement& Placement);
+	void ApplySurfaces(const FRoomLayoutSettings& Settings);
+
+	UWallComponent* CreateWall();
+	void DestroyWall(UWallComponent* wall);
+
+	// Check that every object of description has valid mesh and fits on a wall of described rooms
+	bool ValidateDescription(const FFloorPlanDescription& description);
+
+public:
+
+	UFUNCTION(BlueprintCallable)
+	// Add room and rebuild walls it touches, return room index
+	int32 AddRoom(FBox2D room);
+
+	UFUNCTION(BlueprintCallable)
+	void SetRoom(int32 index, FBox2D room);
+
+	UFUNCTION(BlueprintCallable)
+	// Following room indices are shifted down
+	void RemoveRoom(int32 index);
+
+	UFUNCTION(BlueprintCallable)
+	// Rebuild everything from Rooms
+	void UpdatePlan();
+
+	UFUNCTION(BlueprintCallable)
+	// Walls around room, shared walls are returned for both rooms
+	TArray<UWallComponent*> GetRoomWalls(int32 index) const;
+
+	UFUNCTION(BlueprintCallable)
+	void EnableBoundingBoxes(bool value);
+
+	UFUNCTION(BlueprintCallable)
+	// Add door/window to shared wall, it is visible from both rooms.
+	// Index picks DoorMeshes or WindowMeshes entry and is kept with the opening, default is the first mesh.
+	void AddObjectToWall(UWallComponent* wall, float localPos, ObjectType type, int index = 0);
+
+	UFUNCTION(BlueprintCallable)
+	void RemoveObjectFromWall(UObjectComponent* obj);
+
+	UFUNCTION(BlueprintCallable)
+	void MoveObject(UObjectComponent* obj, float newPos);
+
+	UFUNCTION(BlueprintCallable)
+	// Rooms and doors/windows of every wall
+	FFloorPlanDescription ExportDescription() const;
+
+	UFUNCTION(BlueprintCallable)
+	// Replace plan with description, walls are created and rebuilt once
+	bool BuildFromDescription(const FFloorPlanDescription& description);
+
+	UFUNCTION(BlueprintCallable)
+	// Compact binary form of ExportDescription
+	void SaveToBytes(TArray<uint8>& data) const;
+
+	UFUNCTION(BlueprintCallable)
+	bool LoadFromBytes(const TArray<uint8>& data);
+};
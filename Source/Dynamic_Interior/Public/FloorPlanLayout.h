@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RoomLayout.h"
+
+/**
+ * Engine independent wall graph for floor plans with many rooms.
+ *
+ * Rooms are axis aligned rectangles on wall center lines, so two rooms next to each other
+ * share an edge. Every edge is split where neighbours change and emitted once, a wall
+ * between two rooms keeps both of them in Rooms.
+ */
+
+enum class EFloorPlanAxis : uint8
+{
+	X, // Wall runs along X, center line is Y = Line
+	Y  // Wall runs along Y, center line is X = Line
+};
+
+// Wall between two rooms or between room and outside
+struct FFloorPlanWall
+{
+	EFloorPlanAxis Axis = EFloorPlanAxis::X;
+
+	// Center line coordinate and interval along it in whole centimeters
+	int32 Line	= 0;
+	int32 Start = 0;
+	int32 End	= 0;
+
+	// Rooms on negative and positive side of the center line, INDEX_NONE for outside
+	int32 Rooms[2] = { INDEX_NONE, INDEX_NONE };
+
+	// Interval of solid wall after corners are given to one of crossing walls
+	float SolidStart = 0.0f;
+	float SolidEnd	 = 0.0f;
+
+	bool HasRoom(int32 Room) const
+	{
+		return Room != INDEX_NONE && (Rooms[0] == Room || Rooms[1] == Room);
+	}
+
+	// Same center line interval, rooms may differ
+	bool HasSameEdge(const FFloorPlanWall& Other) const
+	{
+		return Axis == Other.Axis && Line == Other.Line && Start == Other.Start && End == Other.End;
+	}
+};
+
+namespace FloorPlanLayout
+{
+	// Split room edges into shared walls, sorted by axis, line and start.
+	// Room rectangles are snapped to whole centimeters so touching edges match exactly.
+	DYNAMIC_INTERIOR_API void BuildWallGraph(TArrayView<const FBox2D> Rooms, float WallThickness, TArray<FFloorPlanWall>& OutWalls);
+
+	// Return index of wall on center line which contains position, INDEX_NONE if there is no wall
+	DYNAMIC_INTERIOR_API int32 FindWall(TArrayView<const FFloorPlanWall> Walls, EFloorPlanAxis Axis, int32 Line, float Position);
+
+	// Wall transform relative to floor plan, wall local Y runs along the wall like room walls
+	DYNAMIC_INTERIOR_API FWallPlacement ComputeWallPlacement(const FRoomLayoutSettings& Settings, const FFloorPlanWall& Wall);
+
+	// Floor or ceiling covering the room between wall faces
+	DYNAMIC_INTERIOR_API FSegmentTransform ComputeRoomSurface(const FRoomLayoutSettings& Settings, const FBox2D& Room, float Z);
+
+	// Position along wall line of point on the solid wall, used to keep openings when walls are split or merged
+	DYNAMIC_INTERIOR_API float ToLinePosition(const FFloorPlanWall& Wall, float Offset);
+	DYNAMIC_INTERIOR_API float FromLinePosition(const FFloorPlanWall& Wall, float Position);
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "WallComponent.h"
+#include "RoomLayout.h"
+
+#include "InteriorActor.generated.h"
+
+/**
+ * Properties and wall/object helpers shared by ARoom and AFloorPlan.
+ *
+ * Helpers only change components and wall openings, callers mark walls dirty and rebuild
+ * the way their actor does it.
+ */
+UCLASS(Abstract)
+class DYNAMIC_INTERIOR_API AInteriorActor : public AActor
+{
+	GENERATED_BODY()
+
+protected:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configurator properties", meta = (ClampMin = "270.0", ClampMax = "350.0"))
+	float Height = 290.0;
+
+	// Static meshes, wall mesh gives material to procedural walls, floor and ceiling meshes to generated surfaces
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Meshes")
+	UStaticMesh* FloorMesh	 = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Meshes")
+	UStaticMesh* WallMesh	 = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Meshes")
+	UStaticMesh* CeilingMesh = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Meshes|Doors")
+	TArray<UStaticMesh*> DoorMeshes;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Meshes|Windows")
+	TArray<UStaticMesh*> WindowMeshes;
+
+	// Offsets
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets", DisplayName = "Wall Offset")
+	float WallOffset	= 20.0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets", DisplayName = "Door Offset")
+	float DoorOffset	= 4.5;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets", DisplayName = "Window Offset")
+	float WindowOffset	= 18.0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets", DisplayName = "Window Height Offset")
+	float WindowHeightOffset = 100.0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets", DisplayName = "Aligment Offset")
+	float AligmentOffset = 20.0;
+
+	// Size in cm of one texture tile on procedural walls, floor and ceiling
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Rendering", meta = (ClampMin = "1.0"))
+	float WallUVSize = 100.0;
+
+	// Walls get bounding boxes only while picking is enabled
+	bool bBoundingBoxesEnabled = false;
+
+	// Dimensions of door, window and room meshes, filled when meshes are assigned
+	TMap<const UStaticMesh*, FVector> MeshDimensions;
+
+	// Copy shared properties for layout solver, derived actors add their shape
+	virtual FRoomLayoutSettings GetLayoutSettings() const;
+
+	// Return vector that represents static mesh dimensions
+	FVector GetStaticMeshDimensions(UStaticMesh* Mesh);
+
+	// Fill dimension cache for all configurator meshes
+	void CacheMeshDimensions();
+
+	// Create and attach static mesh to wall component
+	UStaticMeshComponent* AddStaticMeshComponent(UWallComponent* WallComponent, UStaticMesh* Mesh, FName Name);
+
+	// Create and attach static mesh to actor root
+	UStaticMeshComponent* AddStaticMeshComponent(UStaticMesh* Mesh, FName Name);
+
+	// Create procedural mesh of wall on first use and write built mesh to it
+	void UpdateWallMesh(UWallComponent* wall, const FWallMeshData& Mesh);
+
+	// Create door/window component and add it to wall without layout update
+	UObjectComponent* CreateObject(UWallComponent* wall, UStaticMesh* Mesh, ObjectType type, int32 meshIndex, float offset);
+
+	// Create door/window in free gap under localPos without layout update, null if mesh index is invalid or gap is too small
+	UObjectComponent* PlaceObject(UWallComponent* wall, float localPos, ObjectType type, int32 meshIndex);
+
+	// Wall the door/window is attached to, null if object is invalid or not on a wall
+	static UWallComponent* GetObjectWall(UObjectComponent* obj);
+
+	// Remove door/window from wall and destroy it without layout update, false if wall does not hold it
+	bool DestroyWallObject(UWallComponent* wall, UObjectComponent* obj);
+
+	// Move door/window between its neighbours without layout update, so wall openings remain sorted
+	void SetObjectPosition(UWallComponent* wall, int32 index, float newPos);
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+};
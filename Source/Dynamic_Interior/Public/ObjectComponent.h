@@ -23,6 +23,7 @@ class DYNAMIC_INTERIOR_API UObjectComponent : public UStaticMeshComponent
 
 public:
 
+	// Copy of the wall opening for blueprints, layout reads openings of the wall
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	ObjectType type;
 
@@ -32,4 +33,19 @@ public:
 	UFUNCTION(BlueprintCallable)
 	// Return vector that represents static mesh dimensions
 	FVector GetDimensions();
+
+	// Store dimensions taken from room mesh cache
+	void SetDimensions(const FVector& value);
+
+	virtual bool SetStaticMesh(UStaticMesh* NewMesh) override;
+
+protected:
+
+	// Registered objects are counted in stat DynamicInterior
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
+	// Cached static mesh dimensions, zero if not computed yet
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector Dimensions = FVector::ZeroVector;
 };
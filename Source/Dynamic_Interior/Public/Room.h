@@ -3,8 +3,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "GameFramework/Actor.h"
-#include "WallComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "InteriorActor.h"
 
 #include "Room.generated.h"
 
@@ -12,13 +12,249 @@ UENUM(BlueprintType)
 enum class RoomType : uint8
 {
 	STANDARD	UMETA(DisplayName = "Empty"),
-	L_SHAPE		UMETA(DisplayName = "With Door")
+	L_SHAPE		UMETA(DisplayName = "With Door"),
+	POLYGON		UMETA(DisplayName = "Polygon")
 };
 
+// Counters of wall segment and object components owned by room
+USTRUCT(BlueprintType)
+struct FSegmentPoolStats
+{
+	GENERATED_BODY()
+
+	// Segments used by walls
+	UPROPERTY(BlueprintReadOnly)
+	int32 Live = 0;
+
+	// Hidden segments waiting for reuse
+	UPROPERTY(BlueprintReadOnly)
+	int32 Pooled = 0;
+
+	// Total created and destroyed segment components
+	UPROPERTY(BlueprintReadOnly)
+	int32 Created = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 Destroyed = 0;
+
+	// Door/window components on walls
+	UPROPERTY(BlueprintReadOnly)
+	int32 Objects = 0;
+
+	// Walls rebuilt since room was created, unchanged walls are skipped by rebuild
+	UPROPERTY(BlueprintReadOnly)
+	int32 WallsRebuilt = 0;
+};
+
+// Wall under cursor ray and place for new door/window on it
+USTRUCT(BlueprintType)
+struct FWallPickResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	UWallComponent* Wall = nullptr;
+
+	// Distance along ray and hit position along wall
+	UPROPERTY(BlueprintReadOnly)
+	float Distance = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float LocalPosition = 0.0f;
+
+	// Nearest free place for the object, pass SlotPosition to AddObjectToWall as localPos
+	UPROPERTY(BlueprintReadOnly)
+	bool bHasSlot = false;
+
+	UPROPERTY(BlueprintReadOnly)
+	float SlotOffset = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float SlotPosition = 0.0f;
+};
+
+// Door or window in saved room, mesh is index in DoorMeshes or WindowMeshes
+USTRUCT(BlueprintType)
+struct FRoomOpeningDescription
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ObjectType Type = ObjectType::DOOR;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MeshIndex = 0;
+
+	// Distance from wall start to the left side of the object
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Offset = 0.0f;
+};
+
+USTRUCT(BlueprintType)
+struct FRoomWallDescription
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FRoomOpeningDescription> Openings;
+};
+
+// Everything needed to rebuild configured room, walls are in wall index order
+USTRUCT(BlueprintType)
+struct FRoomDescription
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	RoomType Type = RoomType::STANDARD;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Length = 440.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Width = 440.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Height = 290.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float CornerX = 200.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float CornerY = 200.0f;
+
+	// Interior corners of polygon room
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FVector2D> Outline;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FRoomWallDescription> Walls;
+};
+
+// Public room edit kept in edit log
+UENUM(BlueprintType)
+enum class ERoomEditType : uint8
+{
+	CreateRoom,
+	AddObject,
+	MoveObject,
+	RemoveObject,
+	SetCorner,
+	SetLength,
+	SetWidth,
+	SetHeight,
+	ClampDimensions,
+	UpdateWall,
+	UpdateAllWalls,
+	SetOutline,
+	BuildFromDescription,
+	BeginEdit,
+	CommitEdit,
+	Undo,
+	Redo,
+	FillWall
+};
+
+// Recorded edit, only fields used by its type are set and saved.
+// Walls and objects are indices at the time of edit, so replay must start from the same room.
+USTRUCT(BlueprintType)
+struct FRoomEdit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ERoomEditType Type = ERoomEditType::CreateRoom;
+
+	// Seconds since recording started
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Time = 0.0f;
+
+	// Seconds spent in edit on game thread, deferred rebuilds are not included
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Duration = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Wall = INDEX_NONE;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Object = INDEX_NONE;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	RoomType Shape = RoomType::STANDARD;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ObjectType Opening = ObjectType::DOOR;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MeshIndex = 0;
+
+	// Requested number of objects
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Count = 0;
+
+	// Position along wall, dimension or pitch
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Value = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector2D Point = FVector2D::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUpdateWalls = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FVector2D> Outline;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FRoomDescription Description;
+};
+
+// Public edits of one room in call order, see ARoom::StartEditLog
+USTRUCT(BlueprintType)
+struct FRoomEditLog
+{
+	GENERATED_BODY()
+
+	// Room when recording started, it has no walls if recording started before room was created
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FRoomDescription Initial;
+
+	// Room when log was saved, replay of edits must end in the same room
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FRoomDescription Final;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FRoomEdit> Edits;
+};
+
+// Room state kept for undo, unchanged outline and walls are shared with previous snapshot
+struct FRoomSnapshot
+{
+	float Length  = 0.0f;
+	float Width	  = 0.0f;
+	float Height  = 0.0f;
+	float CornerX = 0.0f;
+	float CornerY = 0.0f;
+
+	TSharedPtr<const TArray<FVector2D>> Outline;
+	TArray<TSharedPtr<const FRoomWallDescription>> Walls;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FRoomConstructedSignature, ARoom*, Room);
+
 UCLASS()
-class DYNAMIC_INTERIOR_API ARoom : public AActor
+class DYNAMIC_INTERIOR_API ARoom : public AInteriorActor
 {
 	GENERATED_BODY()
+
+	// Headless suite drives protected editing API and checks wall components
+	friend class URoomLayoutBenchmarkCommandlet;
+
+	// Replays edit logs with rebuild after every edit
+	friend class URoomEditReplayCommandlet;
+
+	// Gathers layout input on game thread and applies solved layout
+	friend class URoomLayoutSubsystem;
 	
 public:	
 	// Sets default values for this actor's properties
@@ -33,41 +269,7 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configurator properties", meta = (ClampMin = "440.0", ClampMax = "1000.0"))
 	float Width  = 440.0;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configurator properties", meta = (ClampMin = "270.0", ClampMax = "350.0"))
-	float Height = 290.0;
-
-	// Static meshes
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Meshes")
-	UStaticMesh* FloorMesh	 = nullptr;
-
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Meshes")
-	UStaticMesh* WallMesh	 = nullptr;
-
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Meshes")
-	UStaticMesh* CeilingMesh = nullptr;
-
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Meshes|Doors")
-	TArray<UStaticMesh*> DoorMeshes;
-
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Meshes|Windows")
-	TArray<UStaticMesh*> WindowMeshes;
-
-	// Offsets
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets", DisplayName = "Wall Offset")
-	float WallOffset	= 20.0;
-
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets", DisplayName = "Door Offset")
-	float DoorOffset	= 4.5;
-
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets", DisplayName = "Window Offset")
-	float WindowOffset	= 18.0;
-
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets", DisplayName = "Window Height Offset")
-	float WindowHeightOffset = 100.0;
-
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets", DisplayName = "Aligment Offset")
-	float AligmentOffset = 20.0;
-
+	// Height, meshes and offsets are shared with AFloorPlan in AInteriorActor
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Offsets")
 	float minimalWallLength = 200.0f;
 
@@ -77,49 +279,259 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|L Shape")
 	float cornerY = 200.0;
 
+	// Interior corners of polygon room in order, edges must be axis aligned
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Polygon")
+	TArray<FVector2D> Outline;
+
 	RoomType Type = RoomType::STANDARD;
 
+	// Indexed by wall index, same order as layout placements. WallDirection is the wall index of
+	// standard and L shape rooms, blueprints that used Find on the former map call GetWall instead.
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TMap<WallDirection, UWallComponent*> Walls;
+	TArray<UWallComponent*> Walls;
 
+	// Wall boxes created so far, they exist only after picking was enabled
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	TArray<UBoxComponent*> WallBoundingBoxes;
 
-	// Map for window and door dimensions
-	TMap<ObjectType, FVector> ObjDimensions;
+	// Use one box around the room for picking instead of box per wall, hit wall is found by FindWallAt
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Collision")
+	bool bUseRoomBoundingBox = false;
+
+	UPROPERTY()
+	UBoxComponent* RoomBoundingBox = nullptr;
 
 	// Segments for room corners
 	TArray<TWeakObjectPtr<UStaticMeshComponent>> CornerSegments;
 
-	UStaticMeshComponent* floor1 = nullptr;
-	UStaticMeshComponent* floor2 = nullptr;
+	// Draw wall and corner segments as instances of one component
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Rendering")
+	bool bUseInstancedSegments = false;
+
+	// Generate one mesh per wall with openings cut out instead of scaled segments.
+	// Collision is cooked in background, after an edit it may lag the mesh for a few frames.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Rendering")
+	bool bUseProceduralWalls = false;
+
+	UPROPERTY()
+	UInstancedStaticMeshComponent* WallInstances = nullptr;
+
+	// Room space transforms used in instanced mode
+	TArray<FTransform> CornerTransforms;
+
+	// Corner instances are written on next sync
+	bool bCornerInstancesDirty = true;
+	int32 NumSyncedCorners = 0;
+
+	// Simplify room by distance to camera, levels are switched by URoomLayoutSubsystem
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|LOD")
+	bool bUseDistanceLOD = false;
+
+	// Beyond this distance every wall is one box and doors/windows use proxy meshes
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|LOD", meta = (ClampMin = "0.0"))
+	float WallBoxDistance = 3000.0;
+
+	// Beyond this distance whole room is one merged mesh
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|LOD", meta = (ClampMin = "0.0"))
+	float MergedRoomDistance = 8000.0;
+
+	// Index in DoorMeshes or WindowMeshes of simplified mesh, scaled to fill each opening. INDEX_NONE keeps original meshes.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|LOD")
+	int32 ProxyDoorMesh = INDEX_NONE;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|LOD")
+	int32 ProxyWindowMesh = INDEX_NONE;
+
+	// 0 is full detail, 1 wall boxes and proxy objects, 2 merged room mesh
+	int32 LODLevel = 0;
+
+	// Walls, floor and ceiling of distant room, built when room is first merged
+	UPROPERTY()
+	UProceduralMeshComponent* RoomProxy = nullptr;
+
+	// Room changed since proxy was built
+	bool bRoomProxyDirty = true;
+
+	// Room space box around walls, LOD distance is measured to it
+	FBox LocalBounds = FBox(ForceInit);
+
+	// Collision of all room components, applied on change only
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Collision")
+	bool bRoomCollisionEnabled = true;
+
+	// Defer rebuilds requested during frame and apply them once after actors ticked
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configurator properties|Editing")
+	bool bCoalesceEdits = false;
+
+	// Solve layout on worker threads and apply it on later frames, see URoomLayoutSubsystem
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configurator properties|Editing")
+	bool bAsyncLayout = false;
+
+	// Create components over several frames within URoomLayoutSubsystem budget instead of in BeginPlay
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configurator properties|Editing")
+	bool bProgressiveConstruction = false;
+
+	// Start edit log in begin play, before room is created
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configurator properties|Editing")
+	bool bRecordEdits = false;
+
+	FRoomEditLog EditLog;
+	bool bRecordingEdits = false;
+	double EditLogStart = 0.0;
+
+	// Nesting of public edits and rebuilds, edits made inside them are not recorded
+	int32 EditLogDepth = 0;
+
+	// Public edit, outermost one is added to edit log while recording and becomes one undo step
+	struct FEditScope
+	{
+		FEditScope(ARoom* room, ERoomEditType type);
+		~FEditScope();
+
+		ARoom* Room;
+		ERoomEditType Type;
+		FRoomEdit* Edit = nullptr;
+		double Start = 0.0;
+	};
+
+	// Undo steps kept, 0 disables undo
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configurator properties|Editing", meta = (ClampMin = "0"))
+	int32 MaxUndoSteps = 50;
 
-	UStaticMeshComponent* ceiling1 = nullptr;
-	UStaticMeshComponent* ceiling2 = nullptr;
+	// Last snapshot is current room, first one is state undo stops at
+	TArray<FRoomSnapshot> UndoStack;
+	TArray<FRoomSnapshot> RedoStack;
+
+	// Copy room state, sharing walls and outline which are equal in previous snapshot
+	void CaptureSnapshot(const FRoomSnapshot* previous, FRoomSnapshot& snapshot) const;
+
+	// Restore snapshot in one rebuild, objects are recreated only on walls whose openings changed
+	void ApplySnapshot(const FRoomSnapshot& snapshot);
+
+	// Add undo step after outermost edit if room changed
+	void PushUndoStep();
+
+	// Edit is done but its rebuild is deferred, step is pushed when rebuild has clamped the room
+	bool bUndoStepPending = false;
+
+	// Construction stage, INDEX_NONE when room is not being constructed. Walls are created at stage 0.
+	int32 ConstructionStep = INDEX_NONE;
+	bool bRoomConstructed = false;
+
+	// Nesting of BeginEdit/CommitEdit
+	int32 EditDepth = 0;
+
+	// Changed by every edit, background layout of older revision is dropped
+	uint32 LayoutRevision = 0;
+
+	// Revision of last applied rebuild, it differs from LayoutRevision while a rebuild is pending
+	uint32 AppliedRevision = 0;
+
+	// Construction finished, but its layout waits for background solve or end of frame
+	bool bConstructedPending = false;
+
+	FDelegateHandle EndOfFrameHandle;
+
+	// Room dimensions changed, walls must be clamped before rebuild
+	bool bDimensionsDirty = true;
+
+	// Floor, ceiling and corners must be rebuilt
+	bool bSurfacesDirty = true;
+
+	// Settings used by last rebuild
+	FRoomLayoutSettings AppliedSettings;
+	bool bHasAppliedSettings = false;
+
+	// Max count of hidden segments kept for reuse, extra segments are destroyed
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configurator properties|Pool")
+	int32 MaxPooledSegments = 64;
+
+	// Hidden segments ready for reuse
+	UPROPERTY()
+	TArray<UStaticMeshComponent*> SegmentPool;
+
+	FSegmentPoolStats SegmentPoolStats;
+
+	// Description set before begin play, room is built from it instead of empty walls
+	FRoomDescription PendingDescription;
+	bool bHasPendingDescription = false;
+
+	// Floor and ceiling are single meshes triangulated from room outline
+	UPROPERTY()
+	UProceduralMeshComponent* FloorSurface = nullptr;
+
+	UPROPERTY()
+	UProceduralMeshComponent* CeilingSurface = nullptr;
+
+	// Outline of current floor and ceiling meshes, they are rebuilt only when it changes
+	TArray<FVector2D> AppliedOutline;
 
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	UFUNCTION(BlueprintCallable)
+	// Create picking boxes on first enable, disabled boxes are not updated by layout
 	void EnableBoundingBoxes(bool value);
 
+	// Create room box if needed and fit it around walls
+	void UpdateRoomBoundingBox();
+
 	UFUNCTION(BlueprintCallable)
 	void CreateRoom(RoomType type = RoomType::STANDARD);
 
+	// Create next wall or surface components, last step builds the room. Return true when room is constructed.
+	bool ConstructNextStep();
+
+	// Start undo history and broadcast OnRoomConstructed
+	void NotifyConstructed();
+
+	// Create wall and its corner segment at the end of wall array
+	UWallComponent* CreateWall();
+	void DestroyWall(UWallComponent* wall);
+
+	// Add or remove walls at the end to match count of outline edges
+	void ResizeWalls(int32 num);
+
 	UFUNCTION(BlueprintCallable)
 	// Updates wall acording with door or window if they added
 	void UpdateWall(WallDirection direction);
 
+	UFUNCTION(BlueprintCallable)
+	// Same for any wall index, polygon rooms have more walls than WallDirection names
+	void UpdateWallAt(int32 index);
+
+	UFUNCTION(BlueprintPure)
+	// Wall by direction, null if room has no such wall. Replaces Find on the former Walls map.
+	UWallComponent* GetWall(WallDirection direction) const;
+
 	UFUNCTION(BlueprintCallable)
 	void UpdateAllWalls();
 
+	UFUNCTION(BlueprintCallable)
+	// Set dimension and rebuild only affected walls
+	void SetLength(float value);
+
+	UFUNCTION(BlueprintCallable)
+	void SetWidth(float value);
+
+	UFUNCTION(BlueprintCallable)
+	void SetHeight(float value);
+
 	UFUNCTION(BlueprintCallable)
 	void ClampDimensions();
 
 	UFUNCTION(BlueprintCallable)
-	// Add door/window or remove it and update wall
+	// Add door/window or remove it and update wall.
+	// Index picks DoorMeshes or WindowMeshes entry and is kept with the opening, default is the first mesh.
 	void AddObjectToWall(UWallComponent* wall, float localPos, ObjectType type, int index = 0);
 
+	UFUNCTION(BlueprintCallable)
+	// Add up to count doors/windows of one mesh in free parts of wall and rebuild it once.
+	// Spacing is even without pitch, otherwise objects are pitch apart around wall center. Return number of added objects.
+	int32 FillWallWithObjects(UWallComponent* wall, ObjectType type, int index, int32 count, float pitch = 0.0f);
+
 	UFUNCTION(BlueprintCallable)
 	// Add door/window or remove it and update wall
 	void RemoveObjectFromWall(UObjectComponent* obj);
@@ -128,29 +540,203 @@ protected:
 	// Add door/window or remove it and update wall
 	void MoveObject(UObjectComponent* obj, float newPos);
 
+	// Check mesh indices and opening overlaps before room is touched
+	bool ValidateDescription(const FRoomDescription& description);
+
 	UFUNCTION(BlueprintCallable)
 	void SetCorner(FVector2D corner, bool needUpdateWalls = true);
 
-	// Create and attach statuc mesh to wall component
-	UStaticMeshComponent* AddStaticMeshComponent(UWallComponent* WallComponent, UStaticMesh* Mesh, FName Name);
+	void PrepareWallSegments(UWallComponent* wall);
 
-	// Create and attach static mesh to room actor
-	UStaticMeshComponent* AddStaticMeshComponent(UStaticMesh* Mesh, FName Name);
+	void MarkWallDirty(UWallComponent* wall, EWallDirtyFlags Flags);
 
-	void PrepareWallSegments(UWallComponent* wall);
+	// Rebuild dirty walls and surfaces, walls without changes are skipped.
+	// Solved layout and meshes computed in background replace solving on game thread.
+	void RebuildDirty(const FRoomLayoutResult* Solved = nullptr, TArrayView<const FWallMeshData> Meshes = TArrayView<const FWallMeshData>());
+
+	// Apply background layout, falls back to RebuildDirty if room settings changed since it was gathered
+	void ApplySolvedLayout(const FRoomLayoutResult& Result, TArrayView<const FWallMeshData> Meshes);
+
+	// Rebuild now, on CommitEdit, at end of frame or in background depending on edit mode
+	void RequestRebuild();
+
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	// Grow or shrink segment array using pool
+	void ResizeSegments(UWallComponent* wall, TArray<TWeakObjectPtr<UStaticMeshComponent>>& Segments, int32 Num);
+
+	// Take segment from pool or create new one and attach it to wall
+	UStaticMeshComponent* AcquireSegment(UWallComponent* wall);
+
+	// Hide segment and return it to pool
+	void ReleaseSegment(UStaticMeshComponent* segment);
 
 	void UpdateFloor();
 
-	void UpdateWallTransform(WallDirection direction);
-	void UpdateWallLength(WallDirection direction);
+	// Copy room properties for layout solver
+	virtual FRoomLayoutSettings GetLayoutSettings() const override;
+
+	// Collect wall objects as layout openings
+	void GatherWallInput(UWallComponent* wall, FWallLayoutInput& Input);
+	void GatherLayoutInput(FRoomLayoutInput& Input);
+
+	// Apply solver output to wall and segment components
+	void ApplyWallPlacement(UWallComponent* wall, const FWallPlacement& Placement);
+	void ApplyWallLayout(UWallComponent* wall, const FWallOpenings& Openings, const FWallLayout& Layout, const FWallMeshData* Mesh = nullptr);
+	void ApplyWallMesh(UWallComponent* wall, const FWallOpenings& Openings, const FWallLayout& Layout, const FWallMeshData* Mesh = nullptr);
+	void ApplySegments(UWallComponent* wall, const FWallLayout& Layout);
+	void ApplySurfaces(const FSurfaceLayout& Surfaces);
+
+	// Create and attach instanced static mesh to room actor
+	UInstancedStaticMeshComponent* AddInstancedMeshComponent(UStaticMesh* Mesh, FName Name);
+
+	// Create and attach procedural mesh to room actor
+	UProceduralMeshComponent* AddProceduralMeshComponent(FName Name);
 
-	void ClampWallPosition(WallDirection direction);
+	// Show components of current LOD level, called on level change and after rebuild of simplified room
+	void ApplyLOD();
 
-	// Return vector that represents static mesh dimensions
-	FVector GetStaticMeshDimensions(UStaticMesh* Mesh);
+	// Swap door/window meshes between original and proxy
+	void ApplyObjectLOD(UWallComponent* wall);
+
+	// Build merged mesh from applied placements and outline
+	void UpdateRoomProxy();
+
+	// Level for distance to camera, finer level is taken back only when clearly inside its distance
+	int32 GetLODForDistance(float distance, float hysteresis) const;
+
+	// Push cached segment transforms of changed walls to instanced components
+	void UpdateInstances();
+	void SyncInstances(UInstancedStaticMeshComponent* Component, const TArray<FTransform>& Transforms, const TBitArray<>& Changed);
+
+	// Create components for current segment mode and drop the ones of the other mode
+	void ApplySegmentMode();
+
+	// Rebuild meshes with UVs of current WallUVSize
+	void ApplyWallUVSize();
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+
+	// Broadcast when all components exist and room was built first time.
+	// With async layout or coalesced edits it waits until the first layout is applied.
+	UPROPERTY(BlueprintAssignable)
+	FRoomConstructedSignature OnRoomConstructed;
+
+	UFUNCTION(BlueprintCallable)
+	bool IsRoomConstructed() const;
+
+	UFUNCTION(BlueprintCallable)
+	// Queue following edits until matching CommitEdit
+	void BeginEdit();
+
+	UFUNCTION(BlueprintCallable)
+	// Apply edits queued since BeginEdit in one rebuild
+	void CommitEdit();
+
+	UFUNCTION(BlueprintCallable)
+	// Apply pending edits now
+	void FlushEdits();
+
+	UFUNCTION(BlueprintCallable)
+	FSegmentPoolStats GetSegmentPoolStats() const;
+
+	UFUNCTION(BlueprintCallable)
+	// Destroy pooled segments above limit
+	void TrimSegmentPool(int32 MaxPooled = 0);
+
+	UFUNCTION(BlueprintCallable)
+	// Find closest wall hit by world space ray and nearest legal slot for door/window mesh on it.
+	// Works on wall layout only, physics scene and bounding boxes are not used.
+	// Costs one ray/box test per wall and RoomLayout::FindFreeSlot on the hit wall only.
+	bool PickWall(FVector origin, FVector direction, ObjectType type, int index, FWallPickResult& result);
+
+	UFUNCTION(BlueprintCallable)
+	// Return wall whose face contains world location and position along it, null if there is none
+	UWallComponent* FindWallAt(FVector location, float& localPos) const;
+
+	UFUNCTION(BlueprintCallable)
+	// Room dimensions and doors/windows of every wall
+	FRoomDescription ExportDescription() const;
+
+	UFUNCTION(BlueprintCallable)
+	// Replace room state with description and rebuild every wall once, without replaying edits.
+	// Shape of created room cannot be changed. Before begin play description is kept and used to create the room.
+	bool BuildFromDescription(const FRoomDescription& description);
+
+	UFUNCTION(BlueprintCallable)
+	// Replace outline of polygon room, walls are added or removed to match its edges.
+	// Like room dimensions, outline is stretched on rebuild where a wall is too short for its objects.
+	bool SetOutline(const TArray<FVector2D>& points);
+
+	UFUNCTION(BlueprintCallable)
+	// Compact binary form of ExportDescription
+	void SaveToBytes(TArray<uint8>& data) const;
+
+	UFUNCTION(BlueprintCallable)
+	bool LoadFromBytes(const TArray<uint8>& data);
+
+	UFUNCTION(BlueprintCallable)
+	// Enable or disable collision of all room components, does nothing if state is the same
+	void SetRoomCollisionEnabled(bool value);
+
+	UFUNCTION(BlueprintCallable)
+	// Switch between segment components and instances, every wall is rebuilt in new mode
+	void SetUseInstancedSegments(bool value);
+
+	UFUNCTION(BlueprintCallable)
+	// Set texture tile size, procedural walls, floor and ceiling are rebuilt with new UVs
+	void SetWallUVSize(float value);
+
+	UFUNCTION(BlueprintCallable)
+	// Force LOD level, rooms with distance LOD are switched back by the subsystem
+	void SetLODLevel(int32 level);
+
+	UFUNCTION(BlueprintCallable)
+	int32 GetLODLevel() const;
+
+	UFUNCTION(BlueprintCallable)
+	// Return to state before last edit, edits inside BeginEdit/CommitEdit are one step
+	bool Undo();
+
+	UFUNCTION(BlueprintCallable)
+	bool Redo();
+
+	UFUNCTION(BlueprintCallable)
+	bool CanUndo() const;
+
+	UFUNCTION(BlueprintCallable)
+	bool CanRedo() const;
+
+	UFUNCTION(BlueprintCallable)
+	// Drop undo and redo steps, current room becomes the oldest state
+	void ClearUndoHistory();
+
+	UFUNCTION(BlueprintCallable)
+	// Bytes used by undo and redo steps, shared walls are counted once
+	int32 GetUndoHistorySize() const;
+
+	UFUNCTION(BlueprintCallable)
+	// Record following public edits with time and duration, previous log is dropped.
+	// Replay starts from current room, so undo steps made before recording cannot be replayed.
+	void StartEditLog();
+
+	UFUNCTION(BlueprintCallable)
+	void StopEditLog();
+
+	UFUNCTION(BlueprintCallable)
+	bool IsRecordingEdits() const;
+
+	UFUNCTION(BlueprintCallable)
+	// Compact binary log, replayed by RoomEditReplay commandlet. Final room is taken now or when recording stopped.
+	void SaveEditLog(TArray<uint8>& data);
+
+	const FRoomEditLog& GetEditLog() const;
+
+	// Execute recorded edit, return false if its wall or object does not exist
+	bool ReplayEdit(const FRoomEdit& edit);
 
 };
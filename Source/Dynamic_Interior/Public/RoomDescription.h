@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Room.h"
+#include "FloorPlan.h"
+
+/**
+ * Saved room and floor plan format.
+ *
+ * Binary form is versioned and compact: counts and mesh indices are packed integers, an opening
+ * takes 6-7 bytes. JSON form is readable and meant for tools and diffs, it is several times larger.
+ * Load functions reject foreign, newer or truncated data without touching the output.
+ * Save functions reject descriptions with negative mesh or wall indices and leave the output empty.
+ *
+ * Room edit log stores only fields used by each edit, most edits take 9-16 bytes.
+ */
+namespace RoomDescription
+{
+	DYNAMIC_INTERIOR_API bool Save(const FRoomDescription& Description, TArray<uint8>& OutData);
+	DYNAMIC_INTERIOR_API bool Load(const TArray<uint8>& Data, FRoomDescription& OutDescription);
+
+	DYNAMIC_INTERIOR_API bool Save(const FFloorPlanDescription& Description, TArray<uint8>& OutData);
+	DYNAMIC_INTERIOR_API bool Load(const TArray<uint8>& Data, FFloorPlanDescription& OutDescription);
+
+	DYNAMIC_INTERIOR_API bool Save(const FRoomEditLog& Log, TArray<uint8>& OutData);
+	DYNAMIC_INTERIOR_API bool Load(const TArray<uint8>& Data, FRoomEditLog& OutLog);
+
+	DYNAMIC_INTERIOR_API bool ToJson(const FRoomDescription& Description, FString& OutJson);
+	DYNAMIC_INTERIOR_API bool FromJson(const FString& Json, FRoomDescription& OutDescription);
+
+	DYNAMIC_INTERIOR_API bool ToJson(const FFloorPlanDescription& Description, FString& OutJson);
+	DYNAMIC_INTERIOR_API bool FromJson(const FString& Json, FFloorPlanDescription& OutDescription);
+
+	DYNAMIC_INTERIOR_API bool ToJson(const FRoomEditLog& Log, FString& OutJson);
+}
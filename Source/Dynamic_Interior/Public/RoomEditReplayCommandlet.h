@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "RoomEditReplayCommandlet.generated.h"
+
+/**
+ * Headless replay of room edit logs saved by ARoom::SaveEditLog.
+ *
+ * Usage: UE4Editor-Cmd Dynamic_Interior.uproject -run=RoomEditReplay -logs=<file or directory> -repeat=1 -nullrhi
+ * Directory is searched for *.roomlog files. Edits are replayed without waiting, each edit rebuilds the room
+ * at once unless the log has BeginEdit/CommitEdit around it. Reports replayed and recorded time per edit type.
+ *
+ * Rooms use default project meshes, -class= spawns room blueprint with the meshes used in the session.
+ * Replay must end in the room the log was saved with, -budgetus= limits p99 time of any edit type.
+ * Returns non zero on any failure, so captured sessions can gate headless builds.
+ */
+UCLASS()
+class DYNAMIC_INTERIOR_API URoomEditReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	URoomEditReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
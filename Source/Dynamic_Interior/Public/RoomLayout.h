@@ -0,0 +1,360 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+
+/**
+ * Engine independent room layout core.
+ *
+ * Everything in this file works on plain structs only: no UObjects, components or world access.
+ * ARoom gathers its state into these structs, calls the solver and then applies the result
+ * to its components in one pass. This keeps the geometry measurable outside of a running world.
+ */
+
+// Wall indices of standard and L shape rooms, matches WallDirection values.
+// Polygon room walls are numbered by outline edges instead.
+namespace RoomWallIndex
+{
+	enum Type : int32
+	{
+		North		= 0,
+		South		= 1,
+		West		= 2,
+		East		= 3,
+		NorthEast	= 4,
+		SouthEast	= 5
+	};
+}
+
+enum class ELayoutRoomShape : uint8
+{
+	Standard,
+	LShape,
+
+	// Any closed outline of axis aligned edges, e.g. T or U shaped rooms
+	Polygon
+};
+
+enum class ELayoutOpeningType : uint8
+{
+	Door,
+	Window
+};
+
+// Single door or window, used to add openings to FWallOpenings
+struct FLayoutOpening
+{
+	// Distance from wall start to the left side of the opening
+	float Offset = 0.0f;
+
+	// Opening dimensions along the wall and vertically
+	float Width  = 0.0f;
+	float Height = 0.0f;
+
+	ELayoutOpeningType Type = ELayoutOpeningType::Door;
+
+	float GetEnd() const
+	{
+		return Offset + Width;
+	}
+};
+
+// Doors and windows of one wall sorted by offset.
+// Fields are kept in parallel arrays, so layout passes read only what they need in linear order.
+struct FWallOpenings
+{
+	// Distance from wall start to the left side of each opening
+	TArray<float> Offsets;
+	TArray<float> Widths;
+	TArray<float> Heights;
+	TArray<ELayoutOpeningType> Types;
+
+	// Door or window mesh of the owner, not used by the solver
+	TArray<int32> MeshIndices;
+
+	int32 Num() const
+	{
+		return Offsets.Num();
+	}
+
+	float GetEnd(int32 Index) const
+	{
+		return Offsets[Index] + Widths[Index];
+	}
+
+	FLayoutOpening Get(int32 Index) const
+	{
+		FLayoutOpening Opening;
+		Opening.Offset = Offsets[Index];
+		Opening.Width  = Widths[Index];
+		Opening.Height = Heights[Index];
+		Opening.Type   = Types[Index];
+		return Opening;
+	}
+
+	void Insert(int32 Index, const FLayoutOpening& Opening, int32 MeshIndex = 0)
+	{
+		Offsets.Insert(Opening.Offset, Index);
+		Widths.Insert(Opening.Width, Index);
+		Heights.Insert(Opening.Height, Index);
+		Types.Insert(Opening.Type, Index);
+		MeshIndices.Insert(MeshIndex, Index);
+	}
+
+	// Openings must be added in offset order
+	void Add(const FLayoutOpening& Opening, int32 MeshIndex = 0)
+	{
+		Insert(Num(), Opening, MeshIndex);
+	}
+
+	void RemoveAt(int32 Index)
+	{
+		Offsets.RemoveAt(Index);
+		Widths.RemoveAt(Index);
+		Heights.RemoveAt(Index);
+		Types.RemoveAt(Index);
+		MeshIndices.RemoveAt(Index);
+	}
+
+	void Reset(int32 NewSize = 0)
+	{
+		Offsets.Reset(NewSize);
+		Widths.Reset(NewSize);
+		Heights.Reset(NewSize);
+		Types.Reset(NewSize);
+		MeshIndices.Reset(NewSize);
+	}
+
+	void Reserve(int32 Number)
+	{
+		Offsets.Reserve(Number);
+		Widths.Reserve(Number);
+		Heights.Reserve(Number);
+		Types.Reserve(Number);
+		MeshIndices.Reserve(Number);
+	}
+};
+
+// Relative location and scale of a box segment
+struct FSegmentTransform
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Scale	 = FVector::OneVector;
+
+	bool operator==(const FSegmentTransform& Other) const
+	{
+		return Location == Other.Location && Scale == Other.Scale;
+	}
+};
+
+// Relative location and yaw of a door/window mesh
+struct FOpeningPlacement
+{
+	FVector Location = FVector::ZeroVector;
+	float Yaw = 0.0f;
+
+	bool operator==(const FOpeningPlacement& Other) const
+	{
+		return Location == Other.Location && Yaw == Other.Yaw;
+	}
+};
+
+// Copy of room properties required by the solver
+struct FRoomLayoutSettings
+{
+	ELayoutRoomShape Shape = ELayoutRoomShape::Standard;
+
+	float Length = 440.0f;
+	float Width	 = 440.0f;
+	float Height = 290.0f;
+
+	float WallOffset		 = 20.0f;
+	float DoorOffset		 = 4.5f;
+	float WindowOffset		 = 18.0f;
+	float WindowHeightOffset = 100.0f;
+	float AligmentOffset	 = 20.0f;
+	float MinimalWallLength	 = 200.0f;
+
+	float CornerX = 200.0f;
+	float CornerY = 200.0f;
+
+	// Interior corners of polygon room in order, edge k goes from point k to point k + 1
+	TArray<FVector2D> Outline;
+
+	bool operator==(const FRoomLayoutSettings& Other) const
+	{
+		return Shape == Other.Shape && Outline == Other.Outline
+			&& Length == Other.Length && Width == Other.Width && Height == Other.Height
+			&& WallOffset == Other.WallOffset && DoorOffset == Other.DoorOffset && WindowOffset == Other.WindowOffset
+			&& WindowHeightOffset == Other.WindowHeightOffset && AligmentOffset == Other.AligmentOffset
+			&& MinimalWallLength == Other.MinimalWallLength && CornerX == Other.CornerX && CornerY == Other.CornerY;
+	}
+};
+
+// Interior corners of any room shape, walls are built along the edges
+struct FRoomOutline
+{
+	TArray<FVector2D> Points;
+
+	// Wall index of edge from point k to point k + 1
+	TArray<int32> WallIndices;
+};
+
+// Wall transform relative to the room
+struct FWallPlacement
+{
+	FVector Location = FVector::ZeroVector;
+	float Yaw	 = 0.0f;
+	float Length = 0.0f;
+
+	// Objects on this wall are rotated by 180 degrees
+	bool bFlipObjects = false;
+
+	// Bounding box transform relative to the wall
+	FSegmentTransform Bounds;
+
+	bool operator==(const FWallPlacement& Other) const
+	{
+		return Location == Other.Location && Yaw == Other.Yaw && Length == Other.Length
+			&& bFlipObjects == Other.bFlipObjects && Bounds == Other.Bounds;
+	}
+};
+
+// Layout of a single wall, all transforms are relative to the wall
+struct FWallLayout
+{
+	// Segments between objects
+	TArray<FSegmentTransform> HorizontalSegments;
+
+	// Segments below and above objects
+	TArray<FSegmentTransform> VerticalSegments;
+
+	// One entry per opening, same order as the input
+	TArray<FOpeningPlacement> Openings;
+};
+
+struct FWallLayoutInput
+{
+	FWallOpenings Openings;
+};
+
+// Procedural mesh relative to its component: wall with openings cut out, floor or ceiling
+struct FWallMeshData
+{
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UVs;
+};
+
+// Floor, ceiling and corner segments relative to the room
+struct FSurfaceLayout
+{
+	// Interior corners, floor and ceiling meshes are triangulated from them
+	TArray<FVector2D> Outline;
+
+	TArray<FSegmentTransform> Corners;
+};
+
+struct FRoomLayoutInput
+{
+	FRoomLayoutSettings Settings;
+
+	// Indexed by wall index
+	TArray<FWallLayoutInput> Walls;
+};
+
+struct FRoomLayoutResult
+{
+	// Settings after dimension and corner clamping
+	FRoomLayoutSettings Settings;
+
+	TArray<FWallPlacement> Placements;
+	TArray<FWallLayout> Walls;
+	FSurfaceLayout Surfaces;
+};
+
+namespace RoomLayout
+{
+	// Return count of walls for room shape
+	DYNAMIC_INTERIOR_API int32 GetNumWalls(const FRoomLayoutSettings& Settings);
+
+	// Outline of standard and L shape rooms is made from dimensions, polygon rooms use Settings.Outline
+	DYNAMIC_INTERIOR_API void BuildOutline(const FRoomLayoutSettings& Settings, FRoomOutline& OutOutline);
+
+	// Check that points form simple closed outline of axis aligned edges, each long enough for a wall
+	DYNAMIC_INTERIOR_API bool ValidateOutline(const FRoomLayoutSettings& Settings, TArrayView<const FVector2D> Points, FString& OutError);
+
+	// Return count of horizontal and vertical segments required for openings
+	DYNAMIC_INTERIOR_API void GetSegmentCounts(const FWallOpenings& Openings, int32& OutHorizontal, int32& OutVertical);
+
+	// Placement of every wall in one pass over the outline, indexed by wall index.
+	// Walls lie outside of the outline and are cut back at inner corners.
+	DYNAMIC_INTERIOR_API void ComputeWallPlacements(const FRoomLayoutSettings& Settings, TArray<FWallPlacement>& OutPlacements);
+
+	// True if settings produce same segments and objects for equal wall placement and openings
+	DYNAMIC_INTERIOR_API bool HaveSameSegmentParameters(const FRoomLayoutSettings& A, const FRoomLayoutSettings& B);
+
+	// Fill segment and opening transforms, openings must be sorted by offset
+	DYNAMIC_INTERIOR_API void SolveWall(const FRoomLayoutSettings& Settings, const FWallPlacement& Placement, const FWallOpenings& Openings, FWallLayout& OutLayout);
+
+	// Build wall mesh from solved layout, openings get reveals instead of seams between segments.
+	// UVs are in world units divided by UVSize so material keeps its scale on any wall length.
+	DYNAMIC_INTERIOR_API void BuildWallMesh(const FRoomLayoutSettings& Settings, const FWallPlacement& Placement, const FWallOpenings& Openings, const FWallLayout& Layout, float UVSize, FWallMeshData& OutMesh);
+
+	// Every wall as a solid box in room space, openings are ignored. Used as mesh of distant rooms.
+	DYNAMIC_INTERIOR_API void BuildMergedWallMesh(const FRoomLayoutSettings& Settings, TArrayView<const FWallPlacement> Placements, float UVSize, FWallMeshData& OutMesh);
+
+	// Intersect ray in room space with wall box, return distance along ray and hit point in wall space
+	DYNAMIC_INTERIOR_API bool IntersectWall(const FRoomLayoutSettings& Settings, const FWallPlacement& Placement, const FVector& Origin, const FVector& Direction, float& OutDistance, FVector& OutLocalHit);
+
+	// Check that segments and openings tile the wall without gaps or overlaps, OutError describes first violation
+	DYNAMIC_INTERIOR_API bool ValidateWallLayout(const FRoomLayoutSettings& Settings, const FWallPlacement& Placement, const FWallOpenings& Openings, const FWallLayout& Layout, FString& OutError);
+
+	// Sorted openings queries, all take openings sorted by offset.
+	// Return index of first opening with offset greater than position, it is also insert index
+	DYNAMIC_INTERIOR_API int32 FindOpeningAfter(const FWallOpenings& Openings, float Position);
+
+	// Find offset for new opening of width centered at position in the free gap under position.
+	// With bNearestGap blocked positions fall back to closest gap with enough space.
+	// Gap under position is found by binary search. The fallback then walks gaps outwards on both
+	// sides, so it is linear in the number of too narrow gaps it passes, O(n) in the worst case.
+	DYNAMIC_INTERIOR_API bool FindFreeSlot(const FWallOpenings& Openings, float WallLength, float Aligment, float Width, float Position, bool bNearestGap, float& OutOffset);
+
+	// Clamp new offset of existing opening between its neighbours and wall ends
+	DYNAMIC_INTERIOR_API float ClampOpeningOffset(const FWallOpenings& Openings, float WallLength, float Aligment, int32 Index, float Offset);
+
+	// Move openings of resized wall as little as possible so they fit in order, OutOffsets has one offset per opening.
+	// Openings that do not fit any more are added to OutRemoved in increasing order, their offsets are unchanged.
+	DYNAMIC_INTERIOR_API void FitOpenings(const FWallOpenings& Openings, float WallLength, float Aligment, TArray<float>& OutOffsets, TArray<int32>& OutRemoved);
+
+	// Find sorted offsets for up to Count new openings of width in free gaps, keeping Aligment from everything.
+	// Without pitch openings are spread so that spacing is even across gaps. With pitch they are Pitch apart
+	// on a grid centered on the wall, blocked grid places are skipped. Return number of offsets found.
+	DYNAMIC_INTERIOR_API int32 FillWall(const FWallOpenings& Openings, float WallLength, float Aligment, float Width, int32 Count, float Pitch, TArray<float>& OutOffsets);
+
+	// Grow room so every opening fits on its wall. Outline is stretched past the end of a short wall,
+	// fixed shapes take their dimensions back from it and polygon rooms keep the stretched outline.
+	DYNAMIC_INTERIOR_API void ClampDimensions(FRoomLayoutSettings& Settings, TArrayView<const FWallLayoutInput> Walls);
+
+	// Clamp L shape corner between minimal wall lengths
+	DYNAMIC_INTERIOR_API FVector2D ClampCorner(const FRoomLayoutSettings& Settings, FVector2D Corner);
+
+	DYNAMIC_INTERIOR_API void ComputeSurfaces(const FRoomLayoutSettings& Settings, FSurfaceLayout& OutSurfaces);
+
+	// Ear clipping of simple polygon in any winding, triangles are counterclockwise indices into points.
+	// Return false if no ear is left, which happens only for self intersecting outlines.
+	DYNAMIC_INTERIOR_API bool TriangulateOutline(TArrayView<const FVector2D> Points, TArray<int32>& OutTriangles);
+
+	// Flat mesh at Z = 0 covering outline, facing up for floor and down for ceiling.
+	// UVs are in world units divided by UVSize like wall meshes.
+	DYNAMIC_INTERIOR_API bool BuildSurfaceMesh(TArrayView<const FVector2D> Outline, bool bFaceUp, float UVSize, FWallMeshData& OutMesh);
+
+	// Full room pass: clamping, corners, floors and every wall
+	DYNAMIC_INTERIOR_API void SolveRoom(const FRoomLayoutInput& Input, FRoomLayoutResult& OutResult);
+
+	// Fill room with random dimensions and non overlapping doors/windows, used by benchmarks
+	DYNAMIC_INTERIOR_API void GenerateRandomRoom(FRandomStream& Stream, int32 MaxOpeningsPerWall, FRoomLayoutInput& OutInput);
+}
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "Room.h"
+#include "RoomLayoutBenchmarkCommandlet.generated.h"
+
+class UStaticMesh;
+class AFloorPlan;
+
+// How spawned rooms draw their walls, picked with -walls=segments, instanced or procedural
+enum class ESuiteWallMode : uint8
+{
+	Segments,
+	Instanced,
+	Procedural
+};
+
+/**
+ * Headless benchmark for the room layout core.
+ *
+ * Usage: UE4Editor-Cmd Dynamic_Interior.uproject -run=RoomLayoutBenchmark -rooms=5000 -openings=6 -seed=1 -nullrhi
+ * Reports rooms/second for full room passes and latency percentiles for single wall updates.
+ *
+ * With -actors=20 -ops=200 rooms of both shapes are spawned in a transient world and edited randomly.
+ * Wall segments are checked after every edit, -budgetus= limits p99 edit time and -budgetcomponents=
+ * limits components added by one edit. Every edited room is then saved and loaded into a new actor
+ * which must match it, and its recorded edit log must replay into the same room. Returns non zero
+ * on any failure, so headless builds can gate on it.
+ *
+ * Rooms with progressive construction and background layout are then edited the same way, they are
+ * checked when they report construction and after every flush of the layout subsystem.
+ *
+ * Edits are then undone and redone. Every undo must restore the room of its step and rebuild only walls
+ * it changes, -budgetundobytes= limits average size of one undo step.
+ *
+ * Room suites run once per wall mode with the same seed, so every mode gets the same edits. Segment
+ * components, instances or wall meshes are compared with the solved layout, and edited rooms are
+ * checked at every LOD level. -walls= runs one mode only.
+ *
+ * Last a floor plan room gets doors and windows, then rooms are added next to it and removed again.
+ * Every door and window must stay at its place on the wall line while its wall is split and merged.
+ *
+ * The same checks run as automation tests under DynamicInterior, with smaller counts:
+ * UE4Editor-Cmd Dynamic_Interior.uproject -ExecCmds="Automation RunTests DynamicInterior; Quit" -unattended -nullrhi
+ */
+UCLASS()
+class DYNAMIC_INTERIOR_API URoomLayoutBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	URoomLayoutBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	// Solver throughput and latency, return false if any solved wall, floor mesh or wall fill is invalid
+	bool RunLayoutBenchmark(const FString& Params);
+
+	// Random edits on spawned rooms, return false on invalid wall or exceeded budget
+	bool RunRoomSuite(const FString& Params);
+
+	// Random edits on rooms built and laid out by URoomLayoutSubsystem, return false on invalid wall
+	bool RunAsyncSuite(const FString& Params);
+
+	// Random edits undone and redone, return false if history differs from edited rooms or undo rebuilds unchanged walls
+	bool RunUndoSuite(const FString& Params);
+
+	// Rooms added to and removed from floor plan, return false if a door or window is lost, moved or overlaps another
+	bool RunFloorPlanSuite(const FString& Params);
+
+protected:
+
+	// Default project meshes, same as BP_Room uses
+	UPROPERTY()
+	UStaticMesh* WallMesh = nullptr;
+
+	UPROPERTY()
+	UStaticMesh* FloorMesh = nullptr;
+
+	UPROPERTY()
+	UStaticMesh* CeilingMesh = nullptr;
+
+	UPROPERTY()
+	UStaticMesh* DoorMesh = nullptr;
+
+	UPROPERTY()
+	UStaticMesh* WindowMesh = nullptr;
+
+	// Transient world of running suite
+	UPROPERTY()
+	UWorld* SuiteWorld = nullptr;
+
+	// Wall mode of rooms spawned by running suite
+	ESuiteWallMode WallMode = ESuiteWallMode::Segments;
+
+	// Rooms in order of OnRoomConstructed and first failed check of a constructed room
+	TArray<ARoom*> ConstructedRooms;
+	FString ConstructedFailure;
+
+	// Load meshes and create transient game world without rendering, return false if meshes are missing
+	bool BeginSuiteWorld(const TCHAR* Name);
+	void EndSuiteWorld();
+
+	// Room with default meshes, returned before FinishSpawning so spawner can set it up
+	ARoom* SpawnRoom(RoomType Type);
+
+	// One random edit of room: object added, moved or removed, or room resized
+	void ApplyRandomEdit(ARoom* Room, FRandomStream& Stream);
+
+	UFUNCTION()
+	void HandleRoomConstructed(ARoom* Room);
+
+	// Check applied segments, instances or wall meshes of every wall against its openings
+	bool ValidateRoom(ARoom* Room, FString& OutError) const;
+
+	// Check walls of floor plan against its graph and objects of every wall against its openings
+	bool ValidateFloorPlan(AFloorPlan* Plan, FString& OutError) const;
+};
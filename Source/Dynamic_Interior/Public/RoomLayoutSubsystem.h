@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "RoomLayout.h"
+
+#include "RoomLayoutSubsystem.generated.h"
+
+class ARoom;
+
+/**
+ * Progressive construction and background layout for many rooms.
+ *
+ * Rooms with progressive construction create their components here a few at a time, at most
+ * ConstructionBudgetMs per frame, so spawning a large scene does not stall its first frames.
+ *
+ * Queued rooms are gathered on the game thread once per frame, solved on worker threads and
+ * applied to components on later frames within ApplyBudgetMs. Rooms edited while their layout
+ * was solved skip the stale result, the edit has already queued them again.
+ *
+ * Rooms with distance LOD are checked against the player camera every LODUpdateInterval seconds.
+ * A check is one box distance per room, components are touched only when a room changes level.
+ */
+UCLASS()
+class DYNAMIC_INTERIOR_API URoomLayoutSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Game thread time per frame for applying solved rooms, at least one room is applied every frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Layout")
+	float ApplyBudgetMs = 2.0f;
+
+	// Game thread time per frame for creating room components, at least one step is done every frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Layout")
+	float ConstructionBudgetMs = 2.0f;
+
+	// Seconds between LOD checks of registered rooms
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LOD")
+	float LODUpdateInterval = 0.25f;
+
+	// Part of LOD distance camera must come closer before room returns to finer level
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LOD", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float LODHysteresis = 0.1f;
+
+	// Construct room over next frames, rooms are finished in queue order
+	void QueueConstruction(ARoom* room);
+
+	// Rooms whose LOD level follows camera distance
+	void RegisterLODRoom(ARoom* room);
+	void UnregisterLODRoom(ARoom* room);
+
+	UFUNCTION(BlueprintCallable)
+	// Set LOD level of registered rooms for view location now, e.g. for camera other than player camera
+	void UpdateLOD(FVector viewLocation);
+
+	UFUNCTION(BlueprintCallable)
+	// Solve room layout in background, queued rooms are solved together after actors ticked
+	void QueueRoom(ARoom* room);
+
+	UFUNCTION(BlueprintCallable)
+	void QueueRooms(const TArray<ARoom*>& rooms);
+
+	UFUNCTION(BlueprintCallable)
+	// Finish construction, wait for solving and apply all queued rooms now, e.g. behind loading screen
+	void Flush();
+
+	UFUNCTION(BlueprintCallable)
+	// Nothing under construction, queued, solved or waiting for apply
+	bool IsIdle() const;
+
+protected:
+
+	// Room snapshot and its solved layout
+	struct FRoomJob
+	{
+		TWeakObjectPtr<ARoom> Room;
+		uint32 Revision = 0;
+
+		FRoomLayoutInput Input;
+		FRoomLayoutResult Result;
+
+		// Procedural wall meshes, built only for rooms that use them
+		bool bBuildMeshes = false;
+		float UVSize = 100.0f;
+		TArray<FWallMeshData> Meshes;
+	};
+
+	TArray<TWeakObjectPtr<ARoom>> ConstructedRooms;
+	int32 NextConstructed = 0;
+
+	TArray<TWeakObjectPtr<ARoom>> QueuedRooms;
+
+	// Batch owned by solve task until it completes
+	TArray<FRoomJob> Jobs;
+	FGraphEventRef SolveTask;
+
+	// Next job of completed batch to apply
+	int32 NextApply = 0;
+
+	TArray<TWeakObjectPtr<ARoom>> LODRooms;
+
+	// Time since last LOD check
+	float LODTimer = 0.0f;
+
+	FDelegateHandle PostActorTickHandle;
+
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	// Run construction steps until budget is spent, negative budget finishes all rooms
+	void ConstructRooms(double BudgetSeconds);
+
+	// Gather queued rooms and start solving them on worker threads
+	void StartBatch();
+
+	bool IsBatchSolved() const;
+
+	// Apply solved rooms until budget is spent, negative budget applies all
+	void ApplyBatch(double BudgetSeconds);
+};
@@ -5,7 +5,9 @@
 #include "CoreMinimal.h"
 #include "Components/SceneComponent.h"
 #include "Components/BoxComponent.h"
+#include "ProceduralMeshComponent.h"
 #include "ObjectComponent.h"
+#include "RoomLayout.h"
 
 #include "WallComponent.generated.h"
 
@@ -31,6 +33,17 @@ enum class SegmentDirection : uint8
 	RIGHT	UMETA(DisplayName = "RIGHT")
 };
 
+// What has to be rebuilt on wall
+enum class EWallDirtyFlags : uint8
+{
+	None		= 0,
+	Placement	= 1 << 0, // Wall length or transform
+	Openings	= 1 << 1, // Doors/windows added, removed or moved
+	Segments	= 1 << 2, // Height or offsets used by segments
+	All			= Placement | Openings | Segments
+};
+ENUM_CLASS_FLAGS(EWallDirtyFlags);
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class DYNAMIC_INTERIOR_API UWallComponent : public USceneComponent
 {
@@ -38,9 +51,14 @@ class DYNAMIC_INTERIOR_API UWallComponent : public USceneComponent
 
 public:	
 
+	// Side of standard and L shape rooms, walls of polygon rooms are known by Index only
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	WallDirection Direction;
 
+	// Position in ARoom wall array
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	int32 Index = INDEX_NONE;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	int leftAligment = 20;
 
@@ -52,21 +70,64 @@ public:
 	float ActualLength;
 
 	UPROPERTY()
-	// For storing door or window mesh if exist
+	// Door and window meshes, same order as Openings. They only render what Openings describe.
 	TArray<UObjectComponent*> Objects;
 
+	// Doors and windows sorted by offset, source of truth for layout.
+	// Not a UPROPERTY: it is part of the engine independent layout core and holds no object references.
+	// Walls are created at runtime and not saved with the level, rooms persist through
+	// ARoom::ExportDescription and BuildFromDescription rebuilds openings together with Objects.
+	FWallOpenings Openings;
+
 	// Segments between objects
 	TArray<TWeakObjectPtr<UStaticMeshComponent>> HorizontalSegments;
 
 	// Segments below and above objects
 	TArray<TWeakObjectPtr<UStaticMeshComponent>> VerticalSegments;
 
+	// Room space segment transforms when room uses instanced rendering
+	TArray<FTransform> SegmentInstances;
+
+	// Instances of this wall are written on next sync, count is what the component holds now
+	bool bInstancesDirty = true;
+	int32 NumSyncedInstances = 0;
+
+	// New walls are fully rebuilt on first update
+	EWallDirtyFlags DirtyFlags = EWallDirtyFlags::All;
+
+	// Last layout applied to components, used to skip unchanged transforms
+	FWallPlacement AppliedPlacement;
+	FWallLayout AppliedLayout;
+
+	// Picking box, null until picking is enabled
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	UBoxComponent* BoundingBox = nullptr;
 
+	// Wall mesh when room generates procedural walls
+	UPROPERTY()
+	UProceduralMeshComponent* ProceduralMesh = nullptr;
+
+	// Single box drawn instead of segments when room is far away
+	UPROPERTY()
+	UStaticMeshComponent* LODBox = nullptr;
+
 	// Sets default values for this component's properties
 	UWallComponent();
 
+	// Insert object keeping openings sorted, return its index
+	int32 AddObject(UObjectComponent* obj, const FLayoutOpening& opening, int32 meshIndex = 0);
+
+	bool RemoveObject(UObjectComponent* obj);
+
+	// Binary search by object offset
+	int32 FindObjectIndex(const UObjectComponent* obj) const;
+
+	// Set new offset, it must stay between neighbours. Object component keeps a copy for blueprints.
+	void SetObjectOffset(int32 index, float offset);
+
+	// Create bounding box if needed and fit it to applied placement
+	UBoxComponent* UpdateBoundingBox();
+
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;